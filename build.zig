@@ -1,6 +1,12 @@
 const std = @import("std");
 
+/// The architectures whose stubs and headers are shipped, and so the
+/// targets of every multi-target step. update.sh restricts the arm64
+/// variant of the package to aarch64 here.
+pub const macos_arches = [_]std.Target.Cpu.Arch{ .aarch64, .x86_64 };
+
 pub fn build(b: *std.Build) void {
+    sdk_builder = b;
     const target = b.standardTargetOptions(.{});
     const optimize = b.standardOptimizeOption(.{});
 
@@ -13,24 +19,1321 @@ pub fn build(b: *std.Build) void {
     lib.linkLibC();
     addPaths(lib);
     b.installArtifact(lib);
+
+    const stats = b.addRunArtifact(tool(b, "sdk_stats"));
+    stats.has_side_effects = true;
+    stats.stdio = .inherit;
+    stats.addDirectoryArg(b.path("."));
+    stats.addArg("--output");
+    const stats_json = stats.addOutputFileArg("sdk-stats.json");
+    stats.addArg("--baseline");
+    stats.addFileArg(b.path("sdk-stats.json"));
+    if (b.args) |args| stats.addArgs(args);
+    const stats_step = b.step("sdk-stats", "Report package size per framework and compare it to sdk-stats.json");
+    stats_step.dependOn(&b.addInstallFile(stats_json, "sdk-stats.json").step);
+
+    const objc_frameworks = [_][]const u8{ "Foundation", "AppKit", "Metal", "QuartzCore", "CoreText" };
+    const objc_bindings = b.addRunArtifact(tool(b, "objc_bindings"));
+    const objc_zig = objc_bindings.addOutputFileArg("objc.zig");
+    _ = objc_bindings.addDepFileOutputArg("objc.d");
+    objc_bindings.addDirectoryArg(b.path("."));
+    objc_bindings.addArgs(&objc_frameworks);
+    const objc = b.addModule("objc", .{ .root_source_file = objc_zig });
+    addPathsModule(objc);
+    objc.linkSystemLibrary("objc", .{ .use_pkg_config = .no });
+    for (objc_frameworks) |name| objc.linkFramework(name, .{});
+
+    const objc_step = b.step("objc-bindings", "Generate the Objective-C bindings and link them for each macOS target");
+    objc_step.dependOn(&b.addInstallFile(objc_zig, "objc.zig").step);
+    const objc_unlinked = b.createModule(.{ .root_source_file = objc_zig });
+    const objc_sections_source = b.addWriteFiles().add("objc_sections.zig",
+        \const objc = @import("objc");
+        \
+        \export fn objcSectionsCheck() ?*objc.NSString {
+        \    return objc.NSString.string();
+        \}
+        \
+    );
+    for (macos_arches) |arch| {
+        const check = b.addExecutable(.{
+            .name = b.fmt("objc-check-{s}", .{@tagName(arch)}),
+            .root_source_file = b.path("tools/objc_check.zig"),
+            .target = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos }),
+            .optimize = optimize,
+        });
+        check.root_module.addImport("objc", objc);
+        objc_step.dependOn(&check.step);
+
+        // The relocations of the selector and class references are only
+        // visible before linking.
+        const sections_object = b.addObject(.{
+            .name = b.fmt("objc-sections-{s}", .{@tagName(arch)}),
+            .root_source_file = objc_sections_source,
+            .target = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos }),
+            .optimize = optimize,
+        });
+        sections_object.root_module.addImport("objc", objc_unlinked);
+        const sections_check = b.addRunArtifact(tool(b, "objc_sections"));
+        sections_check.addFileArg(sections_object.getEmittedBin());
+        sections_check.addArgs(&.{ "string", "NSString" });
+        objc_step.dependOn(&sections_check.step);
+    }
+
+    const simd = b.addModule("simd", .{ .root_source_file = b.path("tools/simd.zig") });
+    const simd_step = b.step("simd-abi", "Check the simd and Spatial layouts against the headers for each macOS target");
+    for (macos_arches) |arch| {
+        const simd_target = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos });
+        const layout = b.addTranslateC(.{
+            .root_source_file = b.path("tools/simd_layout.h"),
+            .target = simd_target,
+            .optimize = optimize,
+        });
+        layout.addSystemIncludePath(b.path("include"));
+        const check = b.addExecutable(.{
+            .name = b.fmt("simd-check-{s}", .{@tagName(arch)}),
+            .root_source_file = b.path("tools/simd_check.zig"),
+            .target = simd_target,
+            .optimize = optimize,
+        });
+        check.root_module.addImport("simd", simd);
+        check.root_module.addImport("c", layout.createModule());
+        simd_step.dependOn(&check.step);
+    }
+
+    const availability = b.addRunArtifact(tool(b, "availability"));
+    const availability_zig = availability.addOutputFileArg("availability.zig");
+    _ = availability.addDepFileOutputArg("availability.d");
+    availability.addDirectoryArg(b.path("."));
+    availability.addArgs(&.{ "Foundation", "AppKit", "Metal", "QuartzCore", "CoreGraphics", "CoreText", "CoreVideo", "IOSurface" });
+    const availability_module = b.addModule("availability", .{ .root_source_file = availability_zig });
+    const availability_step = b.step("availability", "Generate the API availability tables and check them for each macOS target");
+    availability_step.dependOn(&b.addInstallFile(availability_zig, "availability.zig").step);
+    for (macos_arches) |arch| {
+        const check = b.addExecutable(.{
+            .name = b.fmt("availability-check-{s}", .{@tagName(arch)}),
+            .root_source_file = b.path("tools/availability_check.zig"),
+            .target = b.resolveTargetQuery(.{
+                .cpu_arch = arch,
+                .os_tag = .macos,
+                .os_version_min = .{ .semver = .{ .major = 11, .minor = 0, .patch = 0 } },
+            }),
+            .optimize = optimize,
+        });
+        check.root_module.addImport("availability", availability_module);
+        availability_step.dependOn(&check.step);
+    }
+
+    const bundles_step = b.step("header-bundles", "Flatten framework umbrella headers per target");
+    var macos_targets: [macos_arches.len]std.Build.ResolvedTarget = undefined;
+    for (&macos_targets, macos_arches) |*macos_target, arch| {
+        macos_target.* = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos });
+    }
+    const bundle_targets: []const std.Build.ResolvedTarget = if (target.result.os.tag == .macos)
+        &.{target}
+    else
+        &macos_targets;
+    for (bundle_targets) |bundle_target| {
+        bundles_step.dependOn(&b.addInstallDirectory(.{
+            .source_dir = addHeaderBundles(b, bundle_target, .{}),
+            .install_dir = .header,
+            .install_subdir = b.fmt("bundles/{s}", .{bundleTriple(b, bundle_target)}),
+        }).step);
+    }
+
+    const sysroot = b.addRunArtifact(tool(b, "sysroot"));
+    sysroot.has_side_effects = true;
+    sysroot.addArg(b.getInstallPath(.prefix, "sysroot"));
+    sysroot.addDirectoryArg(b.path("."));
+    sysroot.addArg(b.graph.zig_exe);
+    for (macos_arches) |arch| sysroot.addArg(@tagName(arch));
+    const sysroot_step = b.step("sysroot", "Link a MacOSX.sdk layout and write zig cc wrappers, CMake toolchain and Meson cross files");
+    sysroot_step.dependOn(&sysroot.step);
+
+    // The remaining steps check or index the whole SDK and are only useful
+    // when working on this package, so consumers do not get them.
+    if (b.pkg_hash.len != 0) return;
+
+    const test_step = b.step("test", "Run the unit tests of the tools");
+    for ([_][]const u8{ "tools/fingerprint.zig", "tools/include_budget.zig", "tools/launch_cost.zig", "tools/objc_bindings.zig", "tools/sdk_stats.zig", "tools/simd.zig", "tools/tbd.zig", "tools/tbd_dylib.zig" }) |path| {
+        const unit_tests = b.addTest(.{ .root_source_file = b.path(path), .target = b.graph.host });
+        test_step.dependOn(&b.addRunArtifact(unit_tests).step);
+    }
+    const fingerprint_cache = b.addRunArtifact(tool(b, "fingerprint_cache_check"));
+    fingerprint_cache.setName("check fingerprint invalidation");
+    _ = fingerprint_cache.addOutputDirectoryArg("fingerprint-cache");
+    fingerprint_cache.addArg(b.graph.zig_exe);
+    fingerprint_cache.addDirectoryArg(b.path("."));
+    // The check copies these into its fixture package.
+    fingerprint_cache.addFileInput(b.path("build.zig"));
+    fingerprint_cache.addFileInput(b.path("tools/fingerprint.zig"));
+    test_step.dependOn(&fingerprint_cache.step);
+
+    const index_step = b.step("clangd-index", "Build a static clangd index of the SDK headers per target");
+    if (b.findProgram(&.{"clangd-indexer"}, &.{})) |indexer| {
+        for (bundle_targets) |index_target| {
+            const index = b.addRunArtifact(tool(b, "clangd_index"));
+            index.setName(b.fmt("clangd index {s}", .{bundleTriple(b, index_target)}));
+            const index_dir = index.addOutputDirectoryArg("clangd");
+            const install_subdir = b.fmt("clangd/{s}", .{bundleTriple(b, index_target)});
+            index.addArg(b.getInstallPath(.prefix, install_subdir));
+            index.addArg(indexer);
+            index.addDirectoryArg(b.path("."));
+            index.addArg(b.fmt("{s}-apple-macos{}", .{
+                @tagName(index_target.result.cpu.arch),
+                index_target.result.os.version_range.semver.min,
+            }));
+            index.addFileInput(sdkFingerprint(b, "Frameworks"));
+            index.addFileInput(sdkFingerprint(b, "include"));
+            index_step.dependOn(&b.addInstallDirectory(.{
+                .source_dir = index_dir,
+                .install_dir = .prefix,
+                .install_subdir = install_subdir,
+            }).step);
+        }
+    } else |_| {
+        index_step.dependOn(&b.addFail("clangd-indexer (from clang-tools-extra) was not found in PATH").step);
+    }
+
+    const universal_files = b.addWriteFiles();
+    const universal = addUniversalExecutable(b, .{
+        .name = "universal-check",
+        .root_source_file = universal_files.add("main.zig",
+            \\extern fn CFAbsoluteTimeGetCurrent() f64;
+            \\
+            \\pub fn main() u8 {
+            \\    return @intFromBool(CFAbsoluteTimeGetCurrent() == 0);
+            \\}
+            \\
+        ),
+    });
+    for (universal.slices) |slice| slice.linkFramework("CoreFoundation");
+    const fat_check = b.addRunArtifact(tool(b, "fat_check"));
+    fat_check.addFileArg(universal.bin);
+    for (macos_arches) |arch| fat_check.addArg(@tagName(arch));
+    const universal_step = b.step("universal", "Build a universal executable, check its fat header independently of lipo and report its launch cost");
+    universal_step.dependOn(&fat_check.step);
+    universal_step.dependOn(&addLaunchCostReport(b, universal.bin, .{}).step);
+
+    // Heavy umbrellas, so the cost of loading their stubs shows.
+    const link_time_files = b.addWriteFiles();
+    const link_time_source = link_time_files.add("main.zig",
+        \\extern fn CFAbsoluteTimeGetCurrent() f64;
+        \\extern fn objc_getClass(name: [*:0]const u8) ?*anyopaque;
+        \\extern fn MTLCreateSystemDefaultDevice() ?*anyopaque;
+        \\
+        \\export fn main() c_int {
+        \\    return @intFromBool(CFAbsoluteTimeGetCurrent() == 0 or
+        \\        objc_getClass("NSApplication") == null or
+        \\        MTLCreateSystemDefaultDevice() == null);
+        \\}
+        \\
+    );
+    const link_time_step = b.step("stub-link-time", "Compare link times against the text stubs and the binary stub dylibs for each macOS target");
+    for (macos_arches) |arch| {
+        const object = b.addObject(.{
+            .name = b.fmt("link-time-{s}", .{@tagName(arch)}),
+            .root_source_file = link_time_source,
+            .target = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos }),
+            .optimize = .ReleaseFast,
+        });
+        const link_time = b.addRunArtifact(tool(b, "link_time"));
+        link_time.setName(b.fmt("link time {s}", .{@tagName(arch)}));
+        link_time.has_side_effects = true;
+        _ = link_time.addOutputDirectoryArg("link-time");
+        link_time.addArg(b.graph.zig_exe);
+        link_time.addArgs(&.{ b.fmt("{s}-macos", .{@tagName(arch)}), "10" });
+        link_time.addFileArg(object.getEmittedBin());
+        link_time.addDirectoryArg(b.path("."));
+        link_time.addDirectoryArg(stubDylibs(b, arch));
+        link_time.addArgs(&.{ "-framework", "AppKit", "-framework", "Foundation", "-framework", "Metal", "-framework", "QuartzCore", "-framework", "CoreText", "-lobjc" });
+        link_time_step.dependOn(&link_time.step);
+    }
+
+    const libcxx_files = b.addWriteFiles();
+    const libcxx_source = libcxx_files.add("main.cpp",
+        \\#include <string>
+        \\#include <vector>
+        \\
+        \\int main() {
+        \\    std::vector<std::string> strings{"libc++"};
+        \\    return strings.front().size() != 6;
+        \\}
+        \\
+    );
+    const libcxx_step = b.step("libcxx-compare", "Compare cold build time and size of linkLibCpp and linkSystemLibCpp for each macOS target");
+    if (!isShipped(b, "lib/libc++.tbd")) {
+        libcxx_step.dependOn(&b.addFail("libcxx-compare: 'lib/libc++.tbd' is not shipped in this package; run update.sh on macOS to add it").step);
+    }
+    for (macos_arches) |arch| {
+        const compare = b.addRunArtifact(tool(b, "libcxx_compare"));
+        compare.setName(b.fmt("libc++ compare {s}", .{@tagName(arch)}));
+        compare.has_side_effects = true;
+        _ = compare.addOutputDirectoryArg("libcxx-compare");
+        compare.addArg(b.graph.zig_exe);
+        compare.addDirectoryArg(b.path("."));
+        compare.addArg(b.fmt("{s}-macos", .{@tagName(arch)}));
+        compare.addFileArg(libcxx_source);
+        libcxx_step.dependOn(&compare.step);
+    }
+
+    const prefix_map = b.addRunArtifact(tool(b, "prefix_map_check"));
+    _ = prefix_map.addOutputDirectoryArg("prefix-map");
+    prefix_map.addArg(b.graph.zig_exe);
+    prefix_map.addDirectoryArg(b.path("."));
+    prefix_map.addFileInput(b.path("build.zig"));
+    prefix_map.addFileInput(sdkFingerprint(b, "Frameworks/CoreFoundation.framework"));
+    prefix_map.addFileInput(sdkFingerprint(b, "include"));
+    const prefix_map_step = b.step("prefix-map", "Check that objects built through addPaths in two checkouts are byte-identical");
+    prefix_map_step.dependOn(&prefix_map.step);
+
+    const system_libs_step = b.step("system-libs", "Cross-link a program with linkSystemLib for each shipped system library and macOS target");
+    for (std.enums.values(SystemLib)) |lib| {
+        // Libraries whose stub update.sh has not shipped yet are skipped,
+        // linkSystemLib would only fail for them.
+        if (!isShipped(b, b.fmt("lib/lib{s}.tbd", .{@tagName(lib)}))) continue;
+        const check = systemLibCheck(lib);
+        const files = b.addWriteFiles();
+        const source = files.add("main.c", b.fmt("#include <{s}>\n\nint main(void) {{\n{s}\n}}\n", .{ check.header, check.main }));
+        for (macos_arches) |arch| {
+            const exe = b.addExecutable(.{
+                .name = b.fmt("system-lib-{s}-{s}", .{ @tagName(lib), @tagName(arch) }),
+                .target = b.resolveTargetQuery(.{ .cpu_arch = arch, .os_tag = .macos }),
+                .optimize = optimize,
+            });
+            exe.addCSourceFile(.{ .file = source });
+            addPaths(exe);
+            linkSystemLib(exe, lib);
+            system_libs_step.dependOn(&exe.step);
+        }
+    }
+
+    const smoke_step = b.step("smoke", "Translate, compile and link a program against each shipped framework for each macOS target");
+    addSmokeTests(b, smoke_step);
 }
 
+/// Also remaps the SDK root to `/SDK` in the C sources of `step`, see
+/// `sdkPrefixMap`, including those added after this call.
 pub fn addPaths(step: *std.Build.Step.Compile) void {
-    step.addSystemFrameworkPath(.{ .cwd_relative = sdkPath("/Frameworks") });
-    step.addSystemIncludePath(.{ .cwd_relative = sdkPath("/include") });
-    step.addLibraryPath(.{ .cwd_relative = sdkPath("/lib") });
+    addPathsModule(step.root_module);
+    const b = step.step.owner;
+    const remap = b.allocator.create(SdkPrefixMapStep) catch @panic("OOM");
+    remap.* = .{
+        .step = std.Build.Step.init(.{
+            .id = .custom,
+            .name = b.fmt("remap SDK paths of {s}", .{step.name}),
+            .owner = b,
+            .makeFn = SdkPrefixMapStep.make,
+        }),
+        .compile = step,
+    };
+    step.step.dependOn(&remap.step);
 }
 
+/// Zig has no per-step C flags, so the flag is added to every C source of
+/// the root module right before the step is built, when no more sources
+/// can be added.
+const SdkPrefixMapStep = struct {
+    step: std.Build.Step,
+    compile: *std.Build.Step.Compile,
+
+    fn make(step: *std.Build.Step, options: std.Build.Step.MakeOptions) !void {
+        _ = options;
+        const remap: *SdkPrefixMapStep = @fieldParentPtr("step", step);
+        addSdkPrefixMapModule(remap.compile.root_module);
+    }
+};
+
 pub fn addPathsModule(m: *std.Build.Module) void {
-    m.addSystemFrameworkPath(.{ .cwd_relative = sdkPath("/Frameworks") });
-    m.addSystemIncludePath(.{ .cwd_relative = sdkPath("/include") });
-    m.addLibraryPath(.{ .cwd_relative = sdkPath("/lib") });
+    const sdk = sdkBuilder(m.owner);
+    m.addSystemFrameworkPath(sdk.path("Frameworks"));
+    m.addSystemIncludePath(sdk.path("include"));
+    m.addLibraryPath(sdk.path("lib"));
+    addSdkPrefixMapModule(m);
+}
+
+/// Remaps the SDK root to `/SDK` in the C sources of `m` that are not
+/// remapped yet. `addPathsModule` only remaps the sources already added, so
+/// call this after adding more to a module not built with `addPaths`.
+pub fn addSdkPrefixMapModule(m: *std.Build.Module) void {
+    const b = m.owner;
+    const flag = sdkPrefixMap(b);
+    for (m.link_objects.items) |link_object| switch (link_object) {
+        .c_source_file => |source| source.flags = withFlag(b, source.flags, flag),
+        .c_source_files => |sources| sources.flags = withFlag(b, sources.flags, flag),
+        else => {},
+    };
+}
+
+fn withFlag(b: *std.Build, flags: []const []const u8, flag: []const u8) []const []const u8 {
+    for (flags) |f| {
+        if (std.mem.eql(u8, f, flag)) return flags;
+    }
+    return std.mem.concat(b.allocator, []const u8, &.{ flags, &.{flag} }) catch @panic("OOM");
+}
+
+/// `-ffile-prefix-map` from the directory this package was fetched to to
+/// `/SDK`, so that `__FILE__`, debug info and object files built against the
+/// SDK are identical across checkouts and hosts, e.g. for reproducible
+/// release artifacts. Zig's own cache keys still contain the checkout path,
+/// as the include paths do, so cache entries are not shared across
+/// checkouts. `addPaths` applies it to every C source of the step.
+/// `zig build prefix-map` checks that objects built through `addPaths` in
+/// two checkouts are byte-identical.
+pub fn sdkPrefixMap(b: *std.Build) []const u8 {
+    if (sdk_prefix_map) |flag| return flag;
+    const sdk = sdkBuilder(b);
+    // Include paths are passed to the compiler relative to the build root
+    // path as given, so that is the prefix to replace.
+    const root = sdk.build_root.path orelse (sdk.build_root.handle.realpathAlloc(b.allocator, ".") catch
+        @panic("unable to resolve the SDK root"));
+    sdk_prefix_map = b.fmt("-ffile-prefix-map={s}=/SDK", .{std.mem.trimRight(u8, root, std.fs.path.sep_str)});
+    return sdk_prefix_map.?;
+}
+
+var sdk_prefix_map: ?[]const u8 = null;
+
+/// System libraries whose headers are shipped in `include/` and whose
+/// stubs are shipped in `lib/`.
+pub const SystemLib = enum {
+    z,
+    bz2,
+    sqlite3,
+    compression,
+    iconv,
+    xml2,
+    curl,
+    ffi,
+};
+
+/// Links `step` against the system copy of `lib` instead of a vendored
+/// build. pkg-config is bypassed so cross builds never pick up host
+/// libraries. `step` fails until `update.sh` ships the stub of `lib`.
+pub fn linkSystemLib(step: *std.Build.Step.Compile, lib: SystemLib) void {
+    const sdk = sdkBuilder(step.step.owner);
+    requireShipped(step, step.step.owner.fmt("lib/lib{s}.tbd", .{@tagName(lib)}));
+    step.linkLibC();
+    step.linkSystemLibrary2(@tagName(lib), .{ .use_pkg_config = .no });
+    switch (lib) {
+        .xml2 => step.addSystemIncludePath(sdk.path("include/libxml2")),
+        .ffi => step.addSystemIncludePath(sdk.path("include/ffi")),
+        else => {},
+    }
+}
+
+/// Compiles the C++ sources of `step` against the libc++ headers shipped in
+/// `include/c++/v1` and dynamically links the system `libc++.1.dylib`,
+/// instead of building and statically linking libc++ from source. Must not
+/// be combined with `linkLibCpp`. `step` fails until `update.sh` ships the
+/// libc++ stub next to the headers.
+pub fn linkSystemLibCpp(step: *std.Build.Step.Compile) void {
+    const b = step.step.owner;
+    const sdk = sdkBuilder(b);
+    requireShipped(step, "lib/libc++.tbd");
+    // The libc++ headers wrap the C headers with #include_next, so they must
+    // be searched before `include/`.
+    step.root_module.include_dirs.insert(b.allocator, 0, .{
+        .path_system = sdk.path("include/c++/v1"),
+    }) catch @panic("OOM");
+    step.linkLibC();
+    // linkSystemLibrary("c++") would make Zig build its own libc++.
+    step.addObjectFile(sdk.path("lib/libc++.tbd"));
+}
+
+/// A header of `lib` and the body of a `main` referencing its API, for the
+/// `system-libs` step.
+fn systemLibCheck(lib: SystemLib) struct { header: []const u8, main: []const u8 } {
+    return switch (lib) {
+        .z => .{ .header = "zlib.h", .main = "    return zlibVersion()[0] == 0;" },
+        .bz2 => .{ .header = "bzlib.h", .main = "    return BZ2_bzlibVersion()[0] == 0;" },
+        .sqlite3 => .{ .header = "sqlite3.h", .main = "    return sqlite3_libversion_number() == 0;" },
+        .compression => .{ .header = "compression.h", .main = "    return compression_encode_scratch_buffer_size(COMPRESSION_LZFSE) == 0;" },
+        .iconv => .{
+            .header = "iconv.h",
+            .main =
+            \\    iconv_t cd = iconv_open("UTF-8", "UTF-16");
+            \\    return iconv_close(cd);
+            ,
+        },
+        .xml2 => .{
+            .header = "libxml/parser.h",
+            .main =
+            \\    xmlCheckVersion(LIBXML_VERSION);
+            \\    return 0;
+            ,
+        },
+        .curl => .{ .header = "curl/curl.h", .main = "    return curl_version()[0] == 0;" },
+        .ffi => .{
+            .header = "ffi.h",
+            .main =
+            \\    ffi_cif cif;
+            \\    return ffi_prep_cif(&cif, FFI_DEFAULT_ABI, 0, &ffi_type_void, NULL) != FFI_OK;
+            ,
+        },
+    };
+}
+
+pub const HeaderBundleOptions = struct {
+    /// Frameworks whose umbrella header `<Name/Name.h>` is flattened.
+    umbrellas: []const []const u8 = &.{
+        "CoreFoundation",
+        "Foundation",
+        "AppKit",
+        "CoreGraphics",
+        "CoreText",
+        "Metal",
+        "QuartzCore",
+    },
+    /// Expand macros while keeping their definitions (`-E -dD`) instead of
+    /// only inlining the included files (`-frewrite-includes`).
+    preprocess: bool = false,
+};
+
+/// Flattens the umbrella header of each framework into a single
+/// self-contained header for `target` and its deployment target. The
+/// returned directory is laid out like the framework includes, so adding it
+/// as an include path ahead of `addPaths` makes `<AppKit/AppKit.h>` resolve
+/// to the bundle. The shipped headers are never modified; bundles are only
+/// regenerated when one of the headers they were built from changes.
+pub fn addHeaderBundles(
+    b: *std.Build,
+    target: std.Build.ResolvedTarget,
+    options: HeaderBundleOptions,
+) std.Build.LazyPath {
+    const sdk = sdkBuilder(b);
+    const triple = bundleTriple(b, target);
+    const bundles = b.addWriteFiles();
+    for (options.umbrellas) |name| {
+        const cc = b.addSystemCommand(&.{ b.graph.zig_exe, "cc", "-E", "-x", "objective-c", "-target", triple });
+        cc.setName(b.fmt("bundle {s} {s}", .{ name, triple }));
+        cc.addArg(if (options.preprocess) "-dD" else "-frewrite-includes");
+        cc.addArg("-iframework");
+        cc.addDirectoryArg(sdk.path("Frameworks"));
+        cc.addArg("-isystem");
+        cc.addDirectoryArg(sdk.path("include"));
+        cc.addArgs(&.{ "-MD", "-MF" });
+        _ = cc.addDepFileOutputArg("bundle.d");
+        cc.addArg("-o");
+        const bundle = cc.addOutputFileArg(b.fmt("{s}.h", .{name}));
+        cc.addFileArg(sdk.path(b.fmt("Frameworks/{s}.framework/Headers/{s}.h", .{ name, name })));
+        _ = bundles.addCopyFile(bundle, b.fmt("{s}/{s}.h", .{ name, name }));
+    }
+    return bundles.getDirectory();
+}
+
+fn bundleTriple(b: *std.Build, target: std.Build.ResolvedTarget) []const u8 {
+    return b.fmt("{s}-macos.{}", .{
+        @tagName(target.result.cpu.arch),
+        target.result.os.version_range.semver.min,
+    });
+}
+
+/// Links `step` against binary stub dylibs generated from the `.tbd` text
+/// stubs for its architecture, which the linker loads without parsing YAML.
+/// The stubs take precedence over the text stubs added by `addPaths`. They
+/// are regenerated only when the fingerprint of `lib` or of a framework
+/// changes.
+pub fn addStubDylibs(step: *std.Build.Step.Compile) void {
+    const b = step.step.owner;
+    const stubs = stubDylibs(b, step.rootModuleTarget().cpu.arch);
+    step.root_module.include_dirs.insert(b.allocator, 0, .{
+        .framework_path = stubs.path(b, "Frameworks"),
+    }) catch @panic("OOM");
+    step.root_module.lib_paths.insert(b.allocator, 0, stubs.path(b, "lib")) catch @panic("OOM");
+}
+
+var stub_dylibs: std.enums.EnumMap(std.Target.Cpu.Arch, std.Build.LazyPath) = .{};
+
+fn stubDylibs(b: *std.Build, arch: std.Target.Cpu.Arch) std.Build.LazyPath {
+    if (stub_dylibs.get(arch)) |stubs| return stubs;
+    const run = b.addRunArtifact(tool(b, "tbd_dylib"));
+    run.setName(b.fmt("generate {s} stub dylibs", .{@tagName(arch)}));
+    const stubs = run.addOutputDirectoryArg("stubs");
+    run.addDirectoryArg(sdkBuilder(b).path("."));
+    run.addArg(@tagName(arch));
+    run.addFileInput(sdkFingerprint(b, "Frameworks"));
+    run.addFileInput(sdkFingerprint(b, "lib"));
+    stub_dylibs.put(arch, stubs);
+    return stubs;
+}
+
+pub const UniversalExecutableOptions = struct {
+    name: []const u8,
+    root_source_file: ?std.Build.LazyPath = null,
+    optimize: std.builtin.OptimizeMode = .Debug,
+    /// Deployment target of all slices; Zig's default if null.
+    os_version_min: ?std.SemanticVersion = null,
+};
+
+pub const UniversalExecutable = struct {
+    /// One slice per entry of `macos_arches`, with `addPaths` and
+    /// `addStubDylibs` applied. Configure them all the same way.
+    slices: [macos_arches.len]*std.Build.Step.Compile,
+    /// The universal binary, e.g. for `b.addInstallBinFile`.
+    bin: std.Build.LazyPath,
+
+    /// Adds C sources to every slice, remapped with `sdkPrefixMap`.
+    pub fn addCSourceFiles(exe: UniversalExecutable, options: std.Build.Module.AddCSourceFilesOptions) void {
+        for (exe.slices) |slice| slice.addCSourceFiles(options);
+    }
+
+    /// Adds a C source to every slice, remapped with `sdkPrefixMap`.
+    pub fn addCSourceFile(exe: UniversalExecutable, source: std.Build.Module.CSourceFile) void {
+        for (exe.slices) |slice| slice.addCSourceFile(source);
+    }
+};
+
+/// Builds an executable for each of `macos_arches` as sibling steps
+/// of one graph, so the slices compile in parallel and share the generated
+/// artifacts they have in common, and merges them into a universal binary.
+/// Runs on any host.
+pub fn addUniversalExecutable(b: *std.Build, options: UniversalExecutableOptions) UniversalExecutable {
+    const lipo = b.addRunArtifact(tool(b, "lipo"));
+    lipo.setName(b.fmt("lipo {s}", .{options.name}));
+    const bin = lipo.addOutputFileArg(options.name);
+    var slices: [macos_arches.len]*std.Build.Step.Compile = undefined;
+    for (&slices, macos_arches) |*slice, arch| {
+        slice.* = b.addExecutable(.{
+            .name = options.name,
+            .root_source_file = options.root_source_file,
+            .target = b.resolveTargetQuery(.{
+                .cpu_arch = arch,
+                .os_tag = .macos,
+                .os_version_min = if (options.os_version_min) |min| .{ .semver = min } else null,
+            }),
+            .optimize = options.optimize,
+        });
+        addPaths(slice.*);
+        addStubDylibs(slice.*);
+        lipo.addArtifactArg(slice.*);
+    }
+    return .{ .slices = slices, .bin = bin };
+}
+
+pub const TimeTraceOptions = struct {
+    /// Minimum duration in microseconds of the events clang records.
+    granularity_us: u32 = 50,
+    /// Number of entries listed in each section of the report.
+    top: u32 = 25,
+};
+
+/// Compiles each C source of `step` with `-ftime-trace`, in the optimize
+/// mode of `step` and in the same compiles as `addIncludeBudget`, and returns
+/// a step that merges the traces of every translation unit into a ranking of
+/// SDK headers by frontend time. Only sources added before this call are
+/// traced.
+pub fn addTimeTraceReport(step: *std.Build.Step.Compile, options: TimeTraceOptions) *std.Build.Step.Run {
+    const b = step.step.owner;
+    const report = b.addRunArtifact(tool(b, "time_trace"));
+    report.has_side_effects = true;
+    const sdk = sdkBuilder(b);
+    report.addDirectoryArg(sdk.path("Frameworks"));
+    report.addDirectoryArg(sdk.path("include"));
+    report.addArg(b.fmt("{d}", .{options.top}));
+    for (addSourceCompiles(step)) |compile| {
+        compile.run.addArg(b.fmt("-ftime-trace-granularity={d}", .{options.granularity_us}));
+        report.addFileArg(compile.run.addPrefixedOutputFileArg("-ftime-trace=", b.fmt("{s}.json", .{compile.stem})));
+    }
+    return report;
+}
+
+/// A compile of one C source of a compile step, see `addSourceCompiles`.
+const SourceCompile = struct {
+    run: *std.Build.Step.Run,
+    /// The source path as given to the compile step, e.g. `src/main.c`.
+    source: []const u8,
+    /// `source` as a file name, e.g. `src_main.c`.
+    stem: []const u8,
+};
+
+/// A Run step per C source of `step` compiling it on its own with the
+/// target, optimize mode, include paths, macros and flags of `step`, for
+/// reports that need per-translation-unit compiler output. `step` itself is
+/// left untouched, so its cache keys do not change, and every output is a
+/// Run output, so no stale output of a removed source is ever read. Each
+/// compile reruns only when a header it read changed. The compiles are
+/// shared by all reports on `step`, which add their flags and outputs to
+/// them, so a source is compiled once however many reports cover it. Only
+/// sources added before this call are covered.
+fn addSourceCompiles(step: *std.Build.Step.Compile) []const SourceCompile {
+    const b = step.step.owner;
+    const entry = source_compiles.getOrPut(b.allocator, step) catch @panic("OOM");
+    if (!entry.found_existing) entry.value_ptr.* = .{};
+    const compiles = entry.value_ptr;
+    for (step.root_module.link_objects.items) |link_object| switch (link_object) {
+        .c_source_file => |source| {
+            addSourceCompile(step, compiles, source.file, source.flags, source.language);
+        },
+        .c_source_files => |sources| for (sources.files) |file| {
+            addSourceCompile(step, compiles, sources.root.path(b, file), sources.flags, sources.language);
+        },
+        else => {},
+    };
+    return compiles.items;
+}
+
+var source_compiles: std.AutoHashMapUnmanaged(*std.Build.Step.Compile, std.ArrayListUnmanaged(SourceCompile)) = .{};
+
+fn addSourceCompile(
+    step: *std.Build.Step.Compile,
+    compiles: *std.ArrayListUnmanaged(SourceCompile),
+    file: std.Build.LazyPath,
+    flags: []const []const u8,
+    language: ?std.Build.Module.CSourceLanguage,
+) void {
+    const b = step.step.owner;
+    const m = step.root_module;
+    const source = file.getDisplayName();
+    for (compiles.items) |compile| {
+        if (std.mem.eql(u8, compile.source, source)) return;
+    }
+    const stem = std.mem.replaceOwned(u8, b.allocator, source, "/", "_") catch @panic("OOM");
+    const run = b.addSystemCommand(&.{ b.graph.zig_exe, if (m.link_libcpp == true) "c++" else "cc", "-target", bundleTriple(b, m.resolved_target.?) });
+    run.setName(b.fmt("compile {s} ({s})", .{ source, step.name }));
+    // What Zig passes for the optimize mode of C sources. zig cc maps -O2
+    // to ReleaseFast, which would define NDEBUG for ReleaseSafe too.
+    run.addArgs(switch (m.optimize orelse .Debug) {
+        .Debug => &.{ "-O0", "-D_DEBUG" },
+        .ReleaseSafe => &.{ "-O2", "-UNDEBUG", "-D_FORTIFY_SOURCE=2" },
+        .ReleaseFast => &.{ "-O2", "-DNDEBUG" },
+        .ReleaseSmall => &.{ "-Os", "-DNDEBUG" },
+    });
+    for (m.include_dirs.items) |include_dir| switch (include_dir) {
+        .path => |path| run.addPrefixedDirectoryArg("-I", path),
+        .path_system => |path| {
+            run.addArg("-isystem");
+            run.addDirectoryArg(path);
+        },
+        .path_after => |path| {
+            run.addArg("-idirafter");
+            run.addDirectoryArg(path);
+        },
+        .framework_path => |path| run.addPrefixedDirectoryArg("-F", path),
+        .framework_path_system => |path| {
+            run.addArg("-iframework");
+            run.addDirectoryArg(path);
+        },
+        .other_step => |other| run.addPrefixedDirectoryArg("-I", other.getEmittedIncludeTree()),
+        .config_header_step => |config_header| run.addPrefixedDirectoryArg("-I", config_header.getOutput().dirname()),
+        else => {},
+    };
+    run.addArgs(m.c_macros.items);
+    run.addArgs(flags);
+    run.addArgs(&.{ "-MD", "-MF" });
+    _ = run.addDepFileOutputArg(b.fmt("{s}.d", .{stem}));
+    run.addArg("-c");
+    if (language) |lang| run.addArgs(&.{ "-x", lang.internalIdentifier() });
+    run.addFileArg(file);
+    run.addArg("-o");
+    _ = run.addOutputFileArg(b.fmt("{s}.o", .{stem}));
+    compiles.append(b.allocator, .{ .run = run, .source = source, .stem = stem }) catch @panic("OOM");
+}
+
+pub const IncludeBudgetOptions = struct {
+    /// Bytes of SDK headers a translation unit may include.
+    max_bytes: u64 = 8 * 1024 * 1024,
+    /// Fail the step instead of warning when a translation unit is over.
+    fail: bool = true,
+};
+
+/// Compiles each C source of `step` on its own with `-H` and returns a step
+/// that sums the SDK header bytes each translation unit includes, reporting
+/// those over `max_bytes` with the umbrella includes and frameworks
+/// responsible. `step` is left untouched; only sources added before this
+/// call are checked.
+pub fn addIncludeBudget(step: *std.Build.Step.Compile, options: IncludeBudgetOptions) *std.Build.Step.Run {
+    const b = step.step.owner;
+    const report = b.addRunArtifact(tool(b, "include_budget"));
+    report.has_side_effects = true;
+    const sdk = sdkBuilder(b);
+    report.addDirectoryArg(sdk.path("Frameworks"));
+    report.addDirectoryArg(sdk.path("include"));
+    report.addArg(b.fmt("{d}", .{options.max_bytes}));
+    report.addArg(if (options.fail) "fail" else "warn");
+    for (addSourceCompiles(step)) |compile| {
+        compile.run.addArgs(&.{ "-H", "-Xclang", "-header-include-file", "-Xclang" });
+        report.addArg(compile.source);
+        report.addFileArg(compile.run.addOutputFileArg(b.fmt("{s}.H", .{compile.stem})));
+    }
+    return report;
+}
+
+pub const LaunchCostOptions = struct {
+    /// Fail when a linked dylib has no imports.
+    fail_unused: bool = false,
+};
+
+/// Returns a step reporting the launch cost of the Mach-O `bin`, e.g.
+/// `step.getEmittedBin()` or `UniversalExecutable.bin`: the images it loads
+/// through its dylibs and their re-exports, imports and binds per dylib, and
+/// its fixup encoding, with dylibs to drop or umbrellas to replace by the
+/// frameworks actually used. Resolved against the `.tbd` stubs, so it runs
+/// on any host.
+pub fn addLaunchCostReport(b: *std.Build, bin: std.Build.LazyPath, options: LaunchCostOptions) *std.Build.Step.Run {
+    const report = b.addRunArtifact(tool(b, "launch_cost"));
+    report.has_side_effects = true;
+    report.addFileArg(bin);
+    report.addDirectoryArg(sdkBuilder(b).path("."));
+    if (options.fail_unused) report.addArg("--fail-unused");
+    return report;
+}
+
+/// Content fingerprint of an SDK subtree: `Frameworks/<Name>.framework`, or
+/// `Frameworks`, `include` or `lib` as a whole. Passing it to
+/// `Run.addFileInput` makes a step rerun only when that subtree changed,
+/// without the step hashing the subtree itself.
+pub fn sdkFingerprint(b: *std.Build, subtree: []const u8) std.Build.LazyPath {
+    return sdkFingerprints(b).path(b, b.fmt("{s}.sha256", .{subtree}));
 }
 
-fn sdkPath(comptime suffix: []const u8) []const u8 {
-    if (suffix[0] != '/') @compileError("suffix must be an absolute path");
-    return comptime blk: {
-        const root_dir = std.fs.path.dirname(@src().file) orelse ".";
-        break :blk root_dir ++ suffix;
+var sdk_fingerprints: ?std.Build.LazyPath = null;
+
+fn sdkFingerprints(b: *std.Build) std.Build.LazyPath {
+    if (sdk_fingerprints) |fingerprints| return fingerprints;
+    const fingerprint = b.allocator.create(FingerprintSdk) catch @panic("OOM");
+    fingerprint.* = .{
+        .step = std.Build.Step.init(.{
+            .id = .custom,
+            .name = "fingerprint SDK",
+            .owner = b,
+            .makeFn = FingerprintSdk.make,
+        }),
+        .exe = tool(b, "fingerprint"),
+        .output = .{ .step = &fingerprint.step },
     };
+    _ = fingerprint.exe.getEmittedBin();
+    fingerprint.step.dependOn(&fingerprint.exe.step);
+    sdk_fingerprints = .{ .generated = .{ .file = &fingerprint.output } };
+    return sdk_fingerprints.?;
+}
+
+/// Runs tools/fingerprint.zig over the SDK. Unlike a Run step with every
+/// SDK file as input, it walks the SDK when it is made rather than when the
+/// build is configured, so only builds that use a fingerprint pay for the
+/// walk. The cache checks each file by size, inode and mtime and only
+/// rehashes the ones that changed; added and removed files and changed
+/// symlinks change the manifest, so the tool reruns once per update.
+const FingerprintSdk = struct {
+    step: std.Build.Step,
+    exe: *std.Build.Step.Compile,
+    output: std.Build.GeneratedFile,
+
+    fn make(step: *std.Build.Step, options: std.Build.Step.MakeOptions) !void {
+        _ = options;
+        const fingerprint: *FingerprintSdk = @fieldParentPtr("step", step);
+        const b = step.owner;
+        const sdk = sdkBuilder(b);
+        const exe_path = fingerprint.exe.getEmittedBin().getPath2(b, step);
+
+        var man = b.graph.cache.obtain();
+        defer man.deinit();
+        _ = try man.addFile(exe_path, null);
+        var link_buf: [std.fs.max_path_bytes]u8 = undefined;
+        for ([_][]const u8{ "Frameworks", "include", "lib" }) |top| {
+            var dir = sdk.build_root.handle.openDir(top, .{ .iterate = true }) catch |err|
+                return step.fail("unable to open '{s}': {s}", .{ top, @errorName(err) });
+            defer dir.close();
+            var walker = try dir.walk(b.allocator);
+            defer walker.deinit();
+            while (try walker.next()) |entry| switch (entry.kind) {
+                .file => {
+                    _ = try man.addFile(sdk.pathFromRoot(b.pathJoin(&.{ top, entry.path })), null);
+                },
+                .sym_link => {
+                    man.hash.addBytes(b.pathJoin(&.{ top, entry.path }));
+                    man.hash.addBytes(try dir.readLink(entry.path, &link_buf));
+                },
+                else => {},
+            };
+        }
+
+        const hit = try step.cacheHit(&man);
+        const digest = man.final();
+        fingerprint.output.path = try b.cache_root.join(b.allocator, &.{ "o", &digest });
+        if (hit) return;
+        const result = std.process.Child.run(.{
+            .allocator = b.allocator,
+            .argv = &.{ exe_path, fingerprint.output.path.?, sdk.pathFromRoot(".") },
+        }) catch |err| return step.fail("unable to run '{s}': {s}", .{ exe_path, @errorName(err) });
+        switch (result.term) {
+            .Exited => |code| if (code != 0) return step.fail("fingerprint failed:\n{s}", .{result.stderr}),
+            else => return step.fail("fingerprint crashed:\n{s}", .{result.stderr}),
+        }
+        try step.writeManifest(&man);
+    }
+};
+
+var sdk_builder: ?*std.Build = null;
+
+/// The builder of this package, so that paths into it resolve wherever the
+/// package was fetched to and are tracked like any other package file.
+fn sdkBuilder(b: *std.Build) *std.Build {
+    if (sdk_builder == null) sdk_builder = b.dependencyFromBuildZig(@This(), .{}).builder;
+    return sdk_builder.?;
+}
+
+fn tool(b: *std.Build, comptime name: []const u8) *std.Build.Step.Compile {
+    return b.addExecutable(.{
+        .name = name,
+        .root_source_file = sdkBuilder(b).path("tools/" ++ name ++ ".zig"),
+        .target = b.graph.host,
+        .optimize = .ReleaseSafe,
+    });
+}
+
+const SmokeTest = struct {
+    /// Framework, or subdirectory of `include/`.
+    name: []const u8,
+    /// Included by the program and, if it is C, translated with translate-c.
+    headers: []const []const u8,
+    /// Objective-C programs also link libobjc.
+    language: enum { c, objc } = .c,
+    frameworks: []const []const u8 = &.{},
+    libs: []const []const u8 = &.{},
+    /// Body of `main`; only needs to reference the API, it is never run.
+    main: []const u8,
+};
+
+/// The frameworks in `update.sh` order, then the `include/` subsystems.
+/// Only content this package ships is listed; a framework added to
+/// `update.sh` gets its entry with the headers and stubs it brings.
+/// Frameworks that ship only headers (CloudKit, CoreAudioTypes, Kernel)
+/// link no framework; their programs are still linked, against libSystem
+/// and for CloudKit libobjc only.
+const smoke_tests = [_]SmokeTest{
+    .{
+        .name = "CoreFoundation",
+        .headers = &.{"CoreFoundation/CoreFoundation.h"},
+        .frameworks = &.{"CoreFoundation"},
+        .main =
+        \\    CFStringRef string = CFStringCreateWithCString(NULL, "smoke", kCFStringEncodingUTF8);
+        \\    CFRelease(string);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "Foundation",
+        .headers = &.{"Foundation/Foundation.h"},
+        .language = .objc,
+        .frameworks = &.{"Foundation"},
+        .main =
+        \\    return [[NSProcessInfo processInfo] processorCount] == 0;
+        ,
+    },
+    .{
+        .name = "IOKit",
+        .headers = &.{ "IOKit/IOKitLib.h", "IOKit/hid/IOHIDManager.h" },
+        .frameworks = &.{ "IOKit", "CoreFoundation" },
+        .main =
+        \\    IOHIDManagerRef manager = IOHIDManagerCreate(kCFAllocatorDefault, kIOHIDOptionsTypeNone);
+        \\    CFRelease(manager);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "Security",
+        .headers = &.{"Security/Security.h"},
+        .frameworks = &.{"Security"},
+        .main =
+        \\    UInt8 bytes[16];
+        \\    return SecRandomCopyBytes(kSecRandomDefault, sizeof bytes, bytes);
+        ,
+    },
+    .{
+        .name = "CoreServices",
+        .headers = &.{"CoreServices/CoreServices.h"},
+        .frameworks = &.{"CoreServices"},
+        .main =
+        \\    return FSEventsGetCurrentEventId() == 0;
+        ,
+    },
+    .{
+        .name = "DiskArbitration",
+        .headers = &.{"DiskArbitration/DiskArbitration.h"},
+        .frameworks = &.{ "DiskArbitration", "CoreFoundation" },
+        .main =
+        \\    DASessionRef session = DASessionCreate(kCFAllocatorDefault);
+        \\    CFRelease(session);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "CFNetwork",
+        .headers = &.{"CFNetwork/CFNetwork.h"},
+        .frameworks = &.{ "CFNetwork", "CoreFoundation" },
+        .main =
+        \\    CFDictionaryRef settings = CFNetworkCopySystemProxySettings();
+        \\    if (settings) CFRelease(settings);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "ApplicationServices",
+        .headers = &.{"ApplicationServices/ApplicationServices.h"},
+        .frameworks = &.{"ApplicationServices"},
+        .main =
+        \\    return !AXIsProcessTrusted();
+        ,
+    },
+    .{
+        .name = "ImageIO",
+        .headers = &.{"ImageIO/ImageIO.h"},
+        .frameworks = &.{"ImageIO"},
+        .main =
+        \\    return CGImageSourceGetTypeID() == 0;
+        ,
+    },
+    .{
+        .name = "GameController",
+        .headers = &.{"GameController/GameController.h"},
+        .language = .objc,
+        .frameworks = &.{"GameController"},
+        .main =
+        \\    return [GCController controllers] == nil;
+        ,
+    },
+    .{
+        .name = "Symbols",
+        .headers = &.{"Symbols/Symbols.h"},
+        .language = .objc,
+        .frameworks = &.{"Symbols"},
+        .main =
+        \\    return [NSSymbolBounceEffect effect] == nil;
+        ,
+    },
+    .{
+        .name = "AudioToolbox",
+        .headers = &.{"AudioToolbox/AudioToolbox.h"},
+        .frameworks = &.{"AudioToolbox"},
+        .main =
+        \\    AudioComponentDescription description = {
+        \\        .componentType = kAudioUnitType_Output,
+        \\        .componentSubType = kAudioUnitSubType_DefaultOutput,
+        \\        .componentManufacturer = kAudioUnitManufacturer_Apple,
+        \\    };
+        \\    return AudioComponentFindNext(NULL, &description) == NULL;
+        ,
+    },
+    .{
+        .name = "CoreAudio",
+        .headers = &.{"CoreAudio/CoreAudio.h"},
+        .frameworks = &.{"CoreAudio"},
+        .main =
+        \\    AudioObjectPropertyAddress address = {
+        \\        kAudioHardwarePropertyDevices,
+        \\        kAudioObjectPropertyScopeGlobal,
+        \\        kAudioObjectPropertyElementMain,
+        \\    };
+        \\    UInt32 size = 0;
+        \\    return AudioObjectGetPropertyDataSize(kAudioObjectSystemObject, &address, 0, NULL, &size);
+        ,
+    },
+    .{
+        .name = "CoreAudioTypes",
+        .headers = &.{"CoreAudioTypes/CoreAudioTypes.h"},
+        .main =
+        \\    AudioStreamBasicDescription format = { .mSampleRate = 48000, .mFormatID = kAudioFormatLinearPCM };
+        \\    return format.mChannelsPerFrame;
+        ,
+    },
+    .{
+        .name = "AudioUnit",
+        .headers = &.{"AudioUnit/AudioUnit.h"},
+        // The AudioUnit stub only forwards old deployment targets to
+        // AudioToolbox.
+        .frameworks = &.{ "AudioUnit", "AudioToolbox" },
+        .main =
+        \\    return AudioUnitInitialize(NULL);
+        ,
+    },
+    .{
+        .name = "Metal",
+        .headers = &.{"Metal/Metal.h"},
+        .language = .objc,
+        .frameworks = &.{"Metal"},
+        .main =
+        \\    return MTLCreateSystemDefaultDevice() == nil;
+        ,
+    },
+    .{
+        .name = "OpenGL",
+        .headers = &.{ "OpenGL/OpenGL.h", "OpenGL/gl3.h" },
+        .frameworks = &.{"OpenGL"},
+        .main =
+        \\    return CGLGetCurrentContext() == NULL && glGetError() != GL_NO_ERROR;
+        ,
+    },
+    .{
+        .name = "CoreGraphics",
+        .headers = &.{"CoreGraphics/CoreGraphics.h"},
+        .frameworks = &.{"CoreGraphics"},
+        .main =
+        \\    CGColorSpaceRef space = CGColorSpaceCreateDeviceRGB();
+        \\    CGColorSpaceRelease(space);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "IOSurface",
+        .headers = &.{"IOSurface/IOSurface.h"},
+        .frameworks = &.{"IOSurface"},
+        .main =
+        \\    return IOSurfaceGetTypeID() == 0;
+        ,
+    },
+    .{
+        .name = "QuartzCore",
+        .headers = &.{"QuartzCore/QuartzCore.h"},
+        .language = .objc,
+        .frameworks = &.{"QuartzCore"},
+        .main =
+        \\    return [CAMetalLayer layer] == nil;
+        ,
+    },
+    .{
+        .name = "CoreImage",
+        .headers = &.{"CoreImage/CoreImage.h"},
+        .language = .objc,
+        .frameworks = &.{"CoreImage"},
+        .main =
+        \\    return [CIContext context] == nil;
+        ,
+    },
+    .{
+        .name = "CoreVideo",
+        .headers = &.{"CoreVideo/CoreVideo.h"},
+        .frameworks = &.{"CoreVideo"},
+        .main =
+        \\    return CVPixelBufferGetTypeID() == 0;
+        ,
+    },
+    .{
+        .name = "CoreText",
+        .headers = &.{"CoreText/CoreText.h"},
+        .frameworks = &.{ "CoreText", "CoreFoundation" },
+        .main =
+        \\    CTFontRef font = CTFontCreateWithName(CFSTR("Menlo"), 12.0, NULL);
+        \\    CFRelease(font);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "ColorSync",
+        .headers = &.{"ColorSync/ColorSync.h"},
+        .frameworks = &.{"ColorSync"},
+        .main =
+        \\    return ColorSyncProfileGetTypeID() == 0;
+        ,
+    },
+    .{
+        .name = "Carbon",
+        .headers = &.{"Carbon/Carbon.h"},
+        .frameworks = &.{ "Carbon", "CoreFoundation" },
+        .main =
+        \\    TISInputSourceRef source = TISCopyCurrentKeyboardInputSource();
+        \\    if (source) CFRelease(source);
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "Cocoa",
+        .headers = &.{"Cocoa/Cocoa.h"},
+        .language = .objc,
+        .frameworks = &.{"Cocoa"},
+        .main =
+        \\    return [NSApplication sharedApplication] == nil;
+        ,
+    },
+    .{
+        .name = "AppKit",
+        .headers = &.{"AppKit/AppKit.h"},
+        .language = .objc,
+        .frameworks = &.{"AppKit"},
+        .main =
+        \\    NSWindow *window = [[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 640, 480)
+        \\                                                   styleMask:NSWindowStyleMaskTitled
+        \\                                                     backing:NSBackingStoreBuffered
+        \\                                                       defer:YES];
+        \\    return window == nil;
+        ,
+    },
+    .{
+        .name = "CoreData",
+        .headers = &.{"CoreData/CoreData.h"},
+        .language = .objc,
+        .frameworks = &.{"CoreData"},
+        .main =
+        \\    return [[NSManagedObjectModel alloc] init] == nil;
+        ,
+    },
+    .{
+        .name = "CloudKit",
+        .headers = &.{"CloudKit/CloudKit.h"},
+        .language = .objc,
+        .main =
+        \\    CKRecordZoneID *zone = nil;
+        \\    return zone != nil;
+        ,
+    },
+    .{
+        .name = "CoreLocation",
+        .headers = &.{"CoreLocation/CoreLocation.h"},
+        .language = .objc,
+        .frameworks = &.{"CoreLocation"},
+        .main =
+        \\    return [[CLLocationManager alloc] init] == nil;
+        ,
+    },
+    .{
+        .name = "Kernel",
+        .headers = &.{"Kernel/IOKit/hidsystem/IOHIDUsageTables.h"},
+        .main =
+        \\    return kHIDUsage_KeyboardA == 0;
+        ,
+    },
+    .{
+        .name = "dispatch",
+        .headers = &.{"dispatch/dispatch.h"},
+        .main =
+        \\    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+        \\    dispatch_semaphore_signal(semaphore);
+        \\    return (int)dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+        ,
+    },
+    .{
+        .name = "os",
+        .headers = &.{ "os/log.h", "os/signpost.h" },
+        .main =
+        \\    os_log_t log = os_log_create("smoke", "smoke");
+        \\    os_log(log, "smoke %llu", os_signpost_id_generate(log));
+        \\    return 0;
+        ,
+    },
+    .{
+        .name = "mach",
+        .headers = &.{ "mach/mach.h", "mach/mach_time.h" },
+        .main =
+        \\    mach_timebase_info_data_t timebase;
+        \\    mach_timebase_info(&timebase);
+        \\    return mach_task_self() == MACH_PORT_NULL || mach_absolute_time() == 0;
+        ,
+    },
+    .{
+        .name = "objc",
+        .headers = &.{ "objc/runtime.h", "objc/message.h" },
+        .libs = &.{"objc"},
+        .main =
+        \\    id object = ((id (*)(Class, SEL))objc_msgSend)(objc_getClass("NSObject"), sel_registerName("new"));
+        \\    return object == NULL;
+        ,
+    },
+    .{
+        .name = "simd",
+        .headers = &.{"simd/simd.h"},
+        .main =
+        \\    simd_float3 v = simd_normalize(simd_make_float3(1, 2, 3));
+        \\    simd_float4 r = simd_mul(matrix_identity_float4x4, simd_make_float4(v, 1));
+        \\    return r.w != 1;
+        ,
+    },
+};
+
+/// Adds to `smoke_step` a smoke test per macOS target for each entry of
+/// `smoke_tests`, and for every other shipped framework one importing its
+/// umbrella header, followed by a report of their timings. An entry that is
+/// not shipped fails the step.
+/// Each test reruns only when a header it includes or the stubs it links
+/// changed, and all of them run in parallel.
+fn addSmokeTests(b: *std.Build, smoke_step: *std.Build.Step) void {
+    var tests = std.ArrayList(SmokeTest).init(b.allocator);
+    for (smoke_tests) |smoke_test| {
+        if (isShipped(b, b.fmt("Frameworks/{s}.framework", .{smoke_test.name})) or
+            isShipped(b, b.fmt("include/{s}", .{smoke_test.name})))
+        {
+            tests.append(smoke_test) catch @panic("OOM");
+        } else {
+            smoke_step.dependOn(&b.addFail(b.fmt("smoke: '{s}' is listed but not shipped; run update.sh on macOS to add it", .{smoke_test.name})).step);
+        }
+    }
+    var frameworks = b.build_root.handle.openDir("Frameworks", .{ .iterate = true }) catch |err|
+        std.debug.panic("unable to open 'Frameworks': {s}", .{@errorName(err)});
+    defer frameworks.close();
+    var it = frameworks.iterate();
+    next: while (it.next() catch |err| std.debug.panic("unable to list 'Frameworks': {s}", .{@errorName(err)})) |entry| {
+        if (!std.mem.endsWith(u8, entry.name, ".framework")) continue;
+        const name = b.dupe(entry.name[0 .. entry.name.len - ".framework".len]);
+        for (smoke_tests) |smoke_test| {
+            if (std.mem.eql(u8, smoke_test.name, name)) continue :next;
+        }
+        tests.append(.{
+            .name = name,
+            .headers = b.allocator.dupe([]const u8, &.{b.fmt("{s}/{s}.h", .{ name, name })}) catch @panic("OOM"),
+            .language = .objc,
+            .frameworks = b.allocator.dupe([]const u8, &.{name}) catch @panic("OOM"),
+            .main = "    return 0;",
+        }) catch @panic("OOM");
+    }
+
+    const smoke = tool(b, "smoke");
+    const report = b.addRunArtifact(smoke);
+    report.setName("smoke report");
+    report.has_side_effects = true;
+    report.addArg("--report");
+    for (tests.items) |smoke_test| {
+        var includes = std.ArrayList(u8).init(b.allocator);
+        for (smoke_test.headers) |header| {
+            includes.writer().print("#{s} <{s}>\n", .{ if (smoke_test.language == .objc) "import" else "include", header }) catch @panic("OOM");
+        }
+        const files = b.addWriteFiles();
+        const header = files.add("smoke.h", includes.items);
+        const source = files.add(
+            switch (smoke_test.language) {
+                .c => "smoke.c",
+                .objc => "smoke.m",
+            },
+            b.fmt("#include \"smoke.h\"\n\nint main(void) {{\n{s}\n}}\n", .{smoke_test.main}),
+        );
+
+        for (macos_arches) |arch| {
+            const triple = b.fmt("{s}-macos", .{@tagName(arch)});
+            const run = b.addRunArtifact(smoke);
+            run.setName(b.fmt("smoke {s} {s}", .{ smoke_test.name, triple }));
+            const out = run.addOutputDirectoryArg("smoke");
+            _ = run.addDepFileOutputArg("smoke.d");
+            run.addArg(b.graph.zig_exe);
+            run.addDirectoryArg(b.path("."));
+            run.addArgs(&.{ smoke_test.name, triple });
+            run.addFileArg(source);
+            if (smoke_test.language == .c) {
+                run.addArg("--translate-c");
+                run.addFileArg(header);
+            }
+            // The depfile covers the headers; the fingerprints cover the
+            // stubs the program links against.
+            for (smoke_test.frameworks) |framework| {
+                run.addArgs(&.{ "-framework", framework });
+                run.addFileInput(sdkFingerprint(b, b.fmt("Frameworks/{s}.framework", .{framework})));
+            }
+            if (smoke_test.language == .objc) run.addArg("-lobjc");
+            for (smoke_test.libs) |lib| run.addArg(b.fmt("-l{s}", .{lib}));
+            if (smoke_test.language == .objc or smoke_test.libs.len > 0) {
+                run.addFileInput(sdkFingerprint(b, "lib"));
+            }
+            report.addFileArg(out.path(b, "timing.txt"));
+        }
+    }
+    smoke_step.dependOn(&report.step);
+}
+
+fn isShipped(b: *std.Build, sub_path: []const u8) bool {
+    sdkBuilder(b).build_root.handle.access(sub_path, .{}) catch return false;
+    return true;
+}
+
+/// Makes `step` fail with a clear error instead of a linker error when
+/// `sub_path` is not shipped in this package yet.
+fn requireShipped(step: *std.Build.Step.Compile, sub_path: []const u8) void {
+    const b = step.step.owner;
+    if (isShipped(b, sub_path)) return;
+    const fail = b.addFail(b.fmt("macos_sdk: '{s}' is not shipped in this package; run update.sh on macOS to add it", .{sub_path}));
+    step.step.dependOn(&fail.step);
 }
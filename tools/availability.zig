@@ -0,0 +1,483 @@
+//! Extracts the macOS availability of the functions, variables, classes,
+//! protocols and enum constants declared in framework headers from their
+//! `API_AVAILABLE`, `API_DEPRECATED` and `API_UNAVAILABLE` annotations (and
+//! the older positional `NS_AVAILABLE`/`CG_AVAILABLE_STARTING` style), and
+//! emits a Zig module that compares them against the deployment target at
+//! comptime. Enum constants without annotations of their own inherit the
+//! availability of their enum, and top-level declarations inherit that of
+//! the enclosing `API_AVAILABLE_BEGIN(...)`/`API_DEPRECATED_BEGIN(...)` ...
+//! `_END` regions. Regions inside `@interface` bodies are not tracked, like
+//! the methods there.
+//!
+//! Usage: availability <output.zig> <depfile> <sdk-root> <framework>...
+
+const std = @import("std");
+const headers = @import("headers.zig");
+
+const identifier = headers.identifier;
+const trailingIdentifier = headers.trailingIdentifier;
+const startsWithKeyword = headers.startsWithKeyword;
+const matching = headers.matching;
+const isMacroName = headers.isMacroName;
+const contains = headers.contains;
+const lessThan = headers.lessThan;
+
+const prelude = @embedFile("availability_prelude.zig");
+
+const Availability = struct {
+    introduced: ?std.SemanticVersion = null,
+    deprecated: ?std.SemanticVersion = null,
+    unavailable: bool = false,
+
+    fn merge(availability: *Availability, other: Availability) void {
+        if (availability.introduced == null) availability.introduced = other.introduced;
+        if (availability.deprecated == null) availability.deprecated = other.deprecated;
+        availability.unavailable = availability.unavailable or other.unavailable;
+    }
+};
+
+const Entries = std.StringArrayHashMap(Availability);
+
+/// Declarations of the prelude, which generated names must not shadow.
+const prelude_names = [_][]const u8{
+    "std",
+    "builtin",
+    "Availability",
+    "always",
+    "available",
+    "deprecated",
+    "platform_macos",
+    "__isPlatformVersionAtLeast",
+};
+
+const whitespace = " \t\r\n";
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 5) fatal("usage: {s} <output.zig> <depfile> <sdk-root> <framework>...", .{args[0]});
+    const output_path = args[1];
+    const dep_path = args[2];
+    const sdk_root = args[3];
+    const frameworks = args[4..];
+
+    var inputs = std.ArrayList([]const u8).init(arena);
+    const tables = try arena.alloc(Entries, frameworks.len);
+    for (frameworks, tables) |name, *entries| {
+        entries.* = Entries.init(arena);
+        const headers_path = try std.fs.path.join(arena, &.{
+            sdk_root, "Frameworks", try std.mem.concat(arena, u8, &.{ name, ".framework" }), "Headers",
+        });
+        var dir = std.fs.cwd().openDir(headers_path, .{ .iterate = true }) catch |err|
+            fatal("unable to open '{s}': {s}", .{ headers_path, @errorName(err) });
+        defer dir.close();
+
+        var paths = std.ArrayList([]const u8).init(arena);
+        var walker = try dir.walk(arena);
+        defer walker.deinit();
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file or !std.mem.endsWith(u8, entry.path, ".h")) continue;
+            try paths.append(try arena.dupe(u8, entry.path));
+        }
+        std.mem.sort([]const u8, paths.items, {}, lessThan);
+
+        for (paths.items) |path| {
+            try inputs.append(try std.fs.path.join(arena, &.{ headers_path, path }));
+            const text = try headers.stripComments(arena, try dir.readFileAlloc(arena, path, 16 << 20));
+            try scan(arena, text, entries);
+        }
+    }
+
+    var output = std.ArrayList(u8).init(arena);
+    const writer = output.writer();
+    try writer.print("//! Generated by tools/availability.zig from the {s} headers. Do not edit.\n\n", .{
+        try std.mem.join(arena, ", ", frameworks),
+    });
+    try writer.writeAll(prelude);
+    for (frameworks, tables) |name, entries| {
+        try writer.print("\npub const {} = struct {{\n", .{std.zig.fmtId(name)});
+        for (entries.keys(), entries.values()) |api, availability| {
+            if (contains(&prelude_names, api) or contains(frameworks, api)) continue;
+            try writer.print("    pub const {}: Availability = .{{", .{std.zig.fmtId(api)});
+            var first = true;
+            if (availability.introduced) |version| {
+                try writer.print(" .introduced = {}", .{fmtVersion(version)});
+                first = false;
+            }
+            if (availability.deprecated) |version| {
+                try writer.print("{s} .deprecated = {}", .{ if (first) "" else ",", fmtVersion(version) });
+                first = false;
+            }
+            if (availability.unavailable) try writer.print("{s} .unavailable = true", .{if (first) "" else ","});
+            try writer.writeAll(" };\n");
+        }
+        try writer.writeAll("};\n");
+    }
+    try std.fs.cwd().writeFile(.{ .sub_path = output_path, .data = output.items });
+    try headers.writeDepFile(arena, dep_path, output_path, inputs.items);
+}
+
+const Boundary = enum { semicolon, open_brace, close_brace, objc, eof };
+
+/// Walks the top-level declarations of a header. Method declarations inside
+/// `@interface` and `@protocol` bodies are not recorded.
+fn scan(arena: std.mem.Allocator, text: []const u8, entries: *Entries) !void {
+    var regions = std.ArrayList(Availability).init(arena);
+    var i: usize = 0;
+    while (i < text.len) {
+        const end, const boundary = nextBoundary(text, i);
+        const stmt = std.mem.trim(u8, text[i..end], whitespace);
+        // Region markers are not followed by a semicolon, so they lead the
+        // first declaration they apply to or the first one after the region.
+        try updateRegions(stmt, &regions);
+        const region = regionAvailability(regions.items);
+        switch (boundary) {
+            .eof => return,
+            .semicolon => {
+                try declaration(stmt, region, entries);
+                i = end + 1;
+            },
+            .close_brace => i = end + 1,
+            .open_brace => {
+                const close = matching(text, end, '{', '}') orelse return;
+                if (std.mem.endsWith(u8, stmt, "extern \"C\"")) {
+                    i = end + 1;
+                } else if (isEnum(stmt)) {
+                    const type_end = std.mem.indexOfScalarPos(u8, text, close, ';') orelse text.len;
+                    var enum_availability = parseAvailability(stmt);
+                    enum_availability.merge(parseAvailability(text[close + 1 .. type_end]));
+                    enum_availability.merge(region);
+                    try enumConstants(text[end + 1 .. close], enum_availability, entries);
+                    i = @min(type_end + 1, text.len);
+                } else if (containsWord(stmt, "typedef") or containsWord(stmt, "struct") or containsWord(stmt, "union")) {
+                    // The declarator after the body is a type, not an API.
+                    i = @min((std.mem.indexOfScalarPos(u8, text, close, ';') orelse text.len) + 1, text.len);
+                } else {
+                    // Inline function definitions.
+                    try declaration(stmt, region, entries);
+                    i = close + 1;
+                }
+            },
+            .objc => {
+                const rest = text[end..];
+                if (startsWithKeyword(rest, "@end")) {
+                    i = end + "@end".len;
+                    continue;
+                }
+                if (startsWithKeyword(rest, "@class")) {
+                    i = (std.mem.indexOfScalarPos(u8, text, end, ';') orelse text.len - 1) + 1;
+                    continue;
+                }
+                const keyword_len = identifier(rest[1..]).?.len + 1;
+                const line_end = std.mem.indexOfAnyPos(u8, text, end, "\n{;") orelse text.len;
+                const header = std.mem.trim(u8, text[end + keyword_len .. line_end], whitespace);
+                const name = identifier(header) orelse {
+                    i = end + 1;
+                    continue;
+                };
+                const after = std.mem.trimLeft(u8, header[name.len..], whitespace);
+                const forward = std.mem.startsWith(u8, rest, "@protocol") and
+                    ((line_end < text.len and text[line_end] == ';') or (after.len > 0 and after[0] == ','));
+                if (forward) {
+                    i = (std.mem.indexOfScalarPos(u8, text, end, ';') orelse text.len - 1) + 1;
+                    continue;
+                }
+                // Categories and extensions share the class name.
+                const category = after.len > 0 and after[0] == '(';
+                if (!category) {
+                    var availability = parseAvailability(stmt);
+                    availability.merge(parseAvailability(header));
+                    availability.merge(region);
+                    try record(entries, name, availability);
+                }
+                const body_end = std.mem.indexOfPos(u8, text, line_end, "@end") orelse text.len;
+                i = @min(body_end + "@end".len, text.len);
+            },
+        }
+    }
+}
+
+/// Applies the `*_BEGIN` and `*_END` availability region markers in `text`,
+/// in order, to the stack of enclosing regions. Markers without arguments,
+/// such as `APPKIT_API_UNAVAILABLE_BEGIN_MACCATALYST`, only concern other
+/// platforms.
+fn updateRegions(text: []const u8, regions: *std.ArrayList(Availability)) !void {
+    var i: usize = 0;
+    while (i < text.len) {
+        if (!std.ascii.isAlphabetic(text[i]) and text[i] != '_') {
+            i += 1;
+            continue;
+        }
+        const name = identifier(text[i..]).?;
+        i += name.len;
+        if (std.mem.indexOf(u8, name, "_BEGIN")) |marker| {
+            const kind = annotationKind(name[0..marker]) orelse continue;
+            var availability: Availability = .{};
+            const after = std.mem.trimLeft(u8, text[i..], whitespace);
+            if (after.len > 0 and after[0] == '(') {
+                const open = text.len - after.len;
+                const close = matching(text, open, '(', ')') orelse return;
+                availability = parseAnnotation(kind, text[open + 1 .. close]);
+                i = close + 1;
+            }
+            try regions.append(availability);
+        } else if (std.mem.indexOf(u8, name, "_END")) |marker| {
+            if (annotationKind(name[0..marker]) != null) _ = regions.pop();
+        }
+    }
+}
+
+/// The availability of the innermost regions, completed by the outer ones.
+fn regionAvailability(regions: []const Availability) Availability {
+    var result: Availability = .{};
+    var i = regions.len;
+    while (i > 0) {
+        i -= 1;
+        result.merge(regions[i]);
+    }
+    return result;
+}
+
+/// The next `;`, `{`, `}` or Objective-C keyword outside parentheses.
+fn nextBoundary(text: []const u8, start: usize) struct { usize, Boundary } {
+    var depth: usize = 0;
+    for (text[start..], start..) |c, i| switch (c) {
+        '(' => depth += 1,
+        ')' => depth -|= 1,
+        ';' => if (depth == 0) return .{ i, .semicolon },
+        '{' => if (depth == 0) return .{ i, .open_brace },
+        '}' => if (depth == 0) return .{ i, .close_brace },
+        '@' => if (depth == 0) {
+            for ([_][]const u8{ "@interface", "@protocol", "@implementation", "@end", "@class" }) |keyword| {
+                if (startsWithKeyword(text[i..], keyword)) return .{ i, .objc };
+            }
+        },
+        else => {},
+    };
+    return .{ text.len, .eof };
+}
+
+fn isEnum(stmt: []const u8) bool {
+    for ([_][]const u8{ "NS_ENUM(", "NS_OPTIONS(", "NS_CLOSED_ENUM(", "NS_ERROR_ENUM(", "CF_ENUM(", "CF_OPTIONS(", "enum " }) |marker| {
+        if (std.mem.indexOf(u8, stmt, marker) != null) return true;
+    }
+    return std.mem.endsWith(u8, stmt, "enum");
+}
+
+fn enumConstants(body: []const u8, enum_availability: Availability, entries: *Entries) !void {
+    var depth: usize = 0;
+    var start: usize = 0;
+    for (body, 0..) |c, i| {
+        switch (c) {
+            '(' => depth += 1,
+            ')' => depth -|= 1,
+            ',' => if (depth == 0) {
+                try enumConstant(body[start..i], enum_availability, entries);
+                start = i + 1;
+            },
+            else => {},
+        }
+    }
+    try enumConstant(body[start..], enum_availability, entries);
+}
+
+fn enumConstant(item: []const u8, enum_availability: Availability, entries: *Entries) !void {
+    const trimmed = std.mem.trim(u8, item, whitespace);
+    const name = identifier(trimmed) orelse return;
+    var availability = parseAvailability(trimmed);
+    availability.merge(enum_availability);
+    try record(entries, name, availability);
+}
+
+/// A function or variable declaration, named by the identifier in front of
+/// the parameter list or, for variables, in front of the annotations.
+fn declaration(stmt: []const u8, region: Availability, entries: *Entries) !void {
+    if (stmt.len == 0 or containsWord(stmt, "typedef")) return;
+    var availability = parseAvailability(stmt);
+    availability.merge(region);
+    if (availability.introduced == null and availability.deprecated == null and !availability.unavailable) return;
+
+    var i: usize = 0;
+    while (std.mem.indexOfScalarPos(u8, stmt, i, '(')) |open| {
+        const before = std.mem.trimRight(u8, stmt[0..open], whitespace);
+        const start = trailingIdentifier(before) orelse return;
+        const name = before[start..];
+        if (isMacroName(name)) {
+            i = (matching(stmt, open, '(', ')') orelse return) + 1;
+            continue;
+        }
+        const inside = std.mem.trimLeft(u8, stmt[open + 1 ..], whitespace);
+        // Function pointers and blocks are variables of a type, skip them.
+        if (inside.len > 0 and (inside[0] == '*' or inside[0] == '^')) return;
+        return record(entries, name, availability);
+    }
+
+    // A variable: the last identifier before the first annotation.
+    var end = stmt.len;
+    var words = std.mem.tokenizeAny(u8, stmt, whitespace ++ "*");
+    while (words.next()) |word| {
+        const id = identifier(word) orelse continue;
+        if (isMacroName(id) and isAnnotation(id)) {
+            end = words.index - word.len;
+            break;
+        }
+    }
+    const before = std.mem.trimRight(u8, stmt[0..end], whitespace);
+    const start = trailingIdentifier(before) orelse return;
+    try record(entries, before[start..], availability);
+}
+
+fn record(entries: *Entries, name: []const u8, availability: Availability) !void {
+    if (availability.introduced == null and availability.deprecated == null and !availability.unavailable) return;
+    const gop = try entries.getOrPut(name);
+    if (!gop.found_existing) gop.value_ptr.* = availability;
+}
+
+const Kind = enum { available, deprecated, unavailable };
+
+/// Whether a macro annotates availability, and how its arguments read.
+fn annotationKind(name: []const u8) ?Kind {
+    for ([_][]const u8{ "SWIFT", "IOS", "_BEGIN", "_END" }) |excluded| {
+        if (std.mem.indexOf(u8, name, excluded) != null) return null;
+    }
+    if (std.mem.endsWith(u8, name, "UNAVAILABLE")) return .unavailable;
+    if (std.mem.indexOf(u8, name, "DEPRECATED") != null) return .deprecated;
+    if (std.mem.indexOf(u8, name, "AVAILABLE") != null) return .available;
+    return null;
+}
+
+fn isAnnotation(name: []const u8) bool {
+    return annotationKind(name) != null;
+}
+
+/// Combines every availability annotation in `text`. Annotations either
+/// list platforms (`API_AVAILABLE(macos(10.11), ios(8.0))`,
+/// `API_DEPRECATED("...", macos(10.0, 10.14))`, `API_UNAVAILABLE(macos)`),
+/// or versions by position with macOS first (`NS_AVAILABLE(10_5, 2_0)`,
+/// `NS_DEPRECATED_MAC(10_0, 10_5)`, `CG_AVAILABLE_STARTING(10.3, 2.0)`).
+fn parseAvailability(text: []const u8) Availability {
+    var result: Availability = .{};
+    var i: usize = 0;
+    while (i < text.len) {
+        if (!std.ascii.isAlphabetic(text[i]) and text[i] != '_') {
+            i += 1;
+            continue;
+        }
+        const name = identifier(text[i..]).?;
+        i += name.len;
+        if (!isMacroName(name)) continue;
+        const kind = annotationKind(name) orelse continue;
+        const after = std.mem.trimLeft(u8, text[i..], whitespace);
+        if (after.len == 0 or after[0] != '(') continue;
+        const open = text.len - after.len;
+        const close = matching(text, open, '(', ')') orelse return result;
+        result.merge(parseAnnotation(kind, text[open + 1 .. close]));
+        i = close + 1;
+    }
+    return result;
+}
+
+fn parseAnnotation(kind: Kind, args_text: []const u8) Availability {
+    var args_buf: [8][]const u8 = undefined;
+    const args = splitArgs(args_text, &args_buf);
+
+    var platform_style = false;
+    for (args) |arg| {
+        const platform = identifier(arg) orelse continue;
+        const rest = std.mem.trimLeft(u8, arg[platform.len..], whitespace);
+        const is_macos = std.mem.eql(u8, platform, "macos") or std.mem.eql(u8, platform, "macosx");
+        if (rest.len > 0 and rest[0] == '(') {
+            platform_style = true;
+            if (!is_macos) continue;
+            var versions_buf: [8][]const u8 = undefined;
+            const close = matching(rest, 0, '(', ')') orelse continue;
+            const versions = splitArgs(rest[1..close], &versions_buf);
+            return switch (kind) {
+                .unavailable => .{ .unavailable = true },
+                .available => .{ .introduced = if (versions.len > 0) parseVersion(versions[0]) else null },
+                .deprecated => .{
+                    .introduced = if (versions.len > 0) parseVersion(versions[0]) else null,
+                    .deprecated = if (versions.len > 1) parseVersion(versions[1]) else null,
+                },
+            };
+        }
+        if (kind == .unavailable and is_macos and rest.len == 0) return .{ .unavailable = true };
+    }
+    if (platform_style or kind == .unavailable or args.len == 0) return .{};
+
+    if (std.mem.eql(u8, args[0], "NA")) return .{ .unavailable = true };
+    return .{
+        .introduced = parseVersion(args[0]),
+        .deprecated = if (kind == .deprecated and args.len > 1) parseVersion(args[1]) else null,
+    };
+}
+
+/// Splits at commas outside parentheses; arguments past the buffer are
+/// dropped.
+fn splitArgs(text: []const u8, buf: [][]const u8) []const []const u8 {
+    var count: usize = 0;
+    var depth: usize = 0;
+    var start: usize = 0;
+    for (text, 0..) |c, i| {
+        switch (c) {
+            '(' => depth += 1,
+            ')' => depth -|= 1,
+            ',' => if (depth == 0 and count < buf.len) {
+                buf[count] = std.mem.trim(u8, text[start..i], whitespace);
+                count += 1;
+                start = i + 1;
+            },
+            else => {},
+        }
+    }
+    if (count < buf.len) {
+        buf[count] = std.mem.trim(u8, text[start..], whitespace);
+        count += 1;
+    }
+    return buf[0..count];
+}
+
+/// `10.15`, `10.15.4` or `10_15`.
+fn parseVersion(text: []const u8) ?std.SemanticVersion {
+    var parts: [3]usize = .{ 0, 0, 0 };
+    var count: usize = 0;
+    var it = std.mem.tokenizeAny(u8, text, "._");
+    while (it.next()) |part| {
+        if (count == parts.len) return null;
+        parts[count] = std.fmt.parseInt(usize, part, 10) catch return null;
+        count += 1;
+    }
+    if (count == 0) return null;
+    return .{ .major = parts[0], .minor = parts[1], .patch = parts[2] };
+}
+
+fn fmtVersion(version: std.SemanticVersion) std.fmt.Formatter(formatVersion) {
+    return .{ .data = version };
+}
+
+fn formatVersion(
+    version: std.SemanticVersion,
+    comptime _: []const u8,
+    _: std.fmt.FormatOptions,
+    writer: anytype,
+) !void {
+    try writer.print(".{{ .major = {d}, .minor = {d}, .patch = {d} }}", .{ version.major, version.minor, version.patch });
+}
+
+fn containsWord(text: []const u8, word: []const u8) bool {
+    var i: usize = 0;
+    while (std.mem.indexOfPos(u8, text, i, word)) |start| : (i = start + word.len) {
+        const end = start + word.len;
+        if ((start == 0 or !headers.isIdentifierChar(text[start - 1])) and
+            (end == text.len or !headers.isIdentifierChar(text[end]))) return true;
+    }
+    return false;
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
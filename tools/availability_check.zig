@@ -0,0 +1,36 @@
+//! Analyzes every entry of the generated availability tables against the
+//! helpers of the module, which lazy analysis would otherwise skip, and
+//! checks their comptime answers for a deployment target of macOS 11, so
+//! that `zig build availability` compiles and links the module for each
+//! macOS target.
+
+const std = @import("std");
+const availability = @import("availability");
+
+const Metal = availability.Metal;
+
+comptime {
+    checkTables();
+    // Introduced in macOS 10.11 and 13.0.
+    if (!availability.always(Metal.MTLCreateSystemDefaultDevice)) @compileError("MTLCreateSystemDefaultDevice is not always available on macOS 11");
+    if (availability.always(Metal.MTLIOCreateCompressionContext)) @compileError("MTLIOCreateCompressionContext is always available on macOS 11");
+}
+
+pub fn main() u8 {
+    // Checks the running OS version, like `@available`.
+    return @intFromBool(availability.available(Metal.MTLIOCreateCompressionContext));
+}
+
+fn checkTables() void {
+    @setEvalBranchQuota(100_000_000);
+    inline for (comptime std.meta.declarations(availability)) |table| {
+        const Table = @field(availability, table.name);
+        if (@TypeOf(Table) != type or @typeInfo(Table) != .@"struct") continue;
+        inline for (comptime std.meta.declarations(Table)) |decl| {
+            const api = @field(Table, decl.name);
+            if (@TypeOf(api) != availability.Availability) continue;
+            _ = availability.always(api);
+            _ = availability.deprecated(api);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+const std = @import("std");
+const builtin = @import("builtin");
+
+/// The macOS versions an API was introduced and deprecated in, from its
+/// header annotations.
+pub const Availability = struct {
+    introduced: ?std.SemanticVersion = null,
+    deprecated: ?std.SemanticVersion = null,
+    /// `API_UNAVAILABLE(macos)`.
+    unavailable: bool = false,
+};
+
+/// Whether `api` exists on every macOS version the build can run on, judged
+/// by the deployment target.
+pub fn always(comptime api: Availability) bool {
+    if (builtin.os.tag != .macos) @compileError("availability is only known for macOS targets");
+    if (api.unavailable) return false;
+    const introduced = api.introduced orelse return true;
+    return builtin.os.version_range.semver.min.order(introduced) != .lt;
+}
+
+/// The equivalent of `@available`. When `always(api)` holds the result is
+/// comptime-known, so the fallback branch is never analyzed or emitted;
+/// otherwise the running OS version is checked like clang does.
+pub inline fn available(comptime api: Availability) bool {
+    if (comptime always(api)) return true;
+    if (comptime api.unavailable) return false;
+    const version = comptime api.introduced.?;
+    return __isPlatformVersionAtLeast(platform_macos, version.major, version.minor, version.patch) != 0;
+}
+
+/// Whether `api` is already deprecated at the deployment target.
+pub fn deprecated(comptime api: Availability) bool {
+    if (builtin.os.tag != .macos) @compileError("availability is only known for macOS targets");
+    const version = api.deprecated orelse return false;
+    return builtin.os.version_range.semver.min.order(version) != .lt;
+}
+
+const platform_macos = 1;
+
+/// Provided by compiler-rt, as for `@available`.
+extern fn __isPlatformVersionAtLeast(platform: u32, major: u32, minor: u32, subminor: u32) i32;
@@ -0,0 +1,137 @@
+//! Builds a static clangd index of the SDK headers for one target: an
+//! Objective-C++ translation unit importing the umbrella headers and the
+//! common libc++ headers is indexed once with `clangd-indexer`, and a
+//! `.clangd` fragment pointing at the index and at the SDK include paths is
+//! written next to it. Projects merge the fragment into their own `.clangd`,
+//! so clangd answers queries about SDK symbols from the index instead of
+//! parsing the headers on every workstation. The fragment and
+//! `compile_commands.json` name the directory the output is installed to,
+//! not the output directory in the cache.
+//!
+//! Usage: clangd_index <output-dir> <install-dir> <clangd-indexer> <sdk-root> <clang-triple>
+
+const std = @import("std");
+
+const umbrellas = [_][]const u8{
+    "CoreFoundation",
+    "Foundation",
+    "AppKit",
+    "CoreGraphics",
+    "CoreText",
+    "Metal",
+    "QuartzCore",
+};
+
+const cxx_headers = [_][]const u8{
+    "algorithm",
+    "atomic",
+    "chrono",
+    "functional",
+    "map",
+    "memory",
+    "mutex",
+    "optional",
+    "string",
+    "string_view",
+    "thread",
+    "unordered_map",
+    "variant",
+    "vector",
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 6) fatal("usage: {s} <output-dir> <install-dir> <clangd-indexer> <sdk-root> <clang-triple>", .{args[0]});
+    try std.fs.cwd().makePath(args[1]);
+    // The index and the fragment refer to files by absolute path.
+    const out_path = try std.fs.cwd().realpathAlloc(arena, args[1]);
+    const install_path = args[2];
+    const indexer_path = args[3];
+    const sdk = try std.fs.cwd().realpathAlloc(arena, args[4]);
+    const triple = args[5];
+    var out = try std.fs.cwd().openDir(out_path, .{});
+    defer out.close();
+
+    var tu = std.ArrayList(u8).init(arena);
+    for (umbrellas) |name| try tu.writer().print("#import <{s}/{s}.h>\n", .{ name, name });
+    for (cxx_headers) |name| try tu.writer().print("#include <{s}>\n", .{name});
+    try out.writeFile(.{ .sub_path = "sdk.mm", .data = tu.items });
+
+    const frameworks = try std.fs.path.join(arena, &.{ sdk, "Frameworks" });
+    const cxx_include = try std.fs.path.join(arena, &.{ sdk, "include", "c++", "v1" });
+    const include = try std.fs.path.join(arena, &.{ sdk, "include" });
+    const flags = [_][]const u8{
+        // Only the SDK and clang's builtin headers, never the host's.
+        "-nostdlibinc",
+        "-nostdinc++",
+        "-iframework",
+        frameworks,
+        "-isystem",
+        cxx_include,
+        "-isystem",
+        include,
+    };
+
+    const arguments = try std.mem.concat(arena, []const u8, &.{
+        &.{ "clang", "-x", "objective-c++", "-std=c++20", "-target", triple },
+        &flags,
+        &.{ "-fsyntax-only", "sdk.mm" },
+    });
+    // The indexer reads the translation unit from the output directory; the
+    // installed commands name the installed copy.
+    try writeCompileCommands(arena, out, out_path, arguments);
+    try runIndexer(arena, indexer_path, out, out_path);
+    try writeCompileCommands(arena, out, install_path, arguments);
+
+    var fragment = std.ArrayList(u8).init(arena);
+    const writer = fragment.writer();
+    try writer.print("# SDK index for {s}, generated by `zig build clangd-index`.\n", .{triple});
+    try writer.print("Index:\n  External:\n    File: {s}\n", .{try std.fs.path.join(arena, &.{ install_path, "sdk.idx" })});
+    try writer.writeAll("CompileFlags:\n  Add:\n");
+    for (flags) |flag| try writer.print("    - {s}\n", .{flag});
+    try out.writeFile(.{ .sub_path = ".clangd", .data = fragment.items });
+}
+
+fn writeCompileCommands(arena: std.mem.Allocator, out: std.fs.Dir, dir: []const u8, arguments: []const []const u8) !void {
+    const Command = struct {
+        directory: []const u8,
+        file: []const u8,
+        arguments: []const []const u8,
+    };
+    const compile_commands = try std.json.stringifyAlloc(arena, [_]Command{.{
+        .directory = dir,
+        .file = try std.fs.path.join(arena, &.{ dir, "sdk.mm" }),
+        .arguments = arguments,
+    }}, .{ .whitespace = .indent_2 });
+    try out.writeFile(.{ .sub_path = "compile_commands.json", .data = compile_commands });
+}
+
+fn runIndexer(arena: std.mem.Allocator, indexer_path: []const u8, out: std.fs.Dir, out_path: []const u8) !void {
+    var indexer = std.process.Child.init(&.{
+        indexer_path,
+        "--executor=all-TUs",
+        "--format=binary",
+        try std.fs.path.join(arena, &.{ out_path, "compile_commands.json" }),
+    }, arena);
+    indexer.stdout_behavior = .Pipe;
+    try indexer.spawn();
+    {
+        const index = try out.createFile("sdk.idx", .{});
+        defer index.close();
+        var fifo = std.fifo.LinearFifo(u8, .{ .Static = 64 * 1024 }).init();
+        try fifo.pump(indexer.stdout.?.reader(), index.writer());
+    }
+    switch (try indexer.wait()) {
+        .Exited => |code| if (code != 0) fatal("{s} exited with code {d}", .{ indexer_path, code }),
+        else => |term| fatal("{s} terminated: {}", .{ indexer_path, term }),
+    }
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,88 @@
+//! Checks a universal binary independently of the tool that wrote it: the
+//! big-endian `fat_header` and `fat_arch` entries (see
+//! `include/mach-o/fat.h`) must describe exactly the expected architectures,
+//! each slice aligned to the page size of its architecture, inside the file,
+//! not overlapping another slice, and starting with a 64-bit Mach-O header of
+//! the same CPU type and subtype, capability bits included.
+//!
+//! Usage: fat_check <binary> <arch>...
+
+const std = @import("std");
+
+const FAT_MAGIC = 0xcafebabe;
+const MH_MAGIC_64 = 0xfeedfacf;
+const CPU_TYPE_ARM64 = 0x0100000c;
+const CPU_TYPE_X86_64 = 0x01000007;
+
+const Arch = struct {
+    name: []const u8,
+    cputype: u32,
+    /// log2 of the page size.
+    @"align": u32,
+};
+
+const arches = [_]Arch{
+    .{ .name = "aarch64", .cputype = CPU_TYPE_ARM64, .@"align" = 14 },
+    .{ .name = "x86_64", .cputype = CPU_TYPE_X86_64, .@"align" = 12 },
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 3) fatal("usage: {s} <binary> <arch>...", .{args[0]});
+    const path = args[1];
+    const bytes = try std.fs.cwd().readFileAlloc(arena, path, 1 << 30);
+
+    var expected = std.ArrayList(Arch).init(arena);
+    for (args[2..]) |name| {
+        for (arches) |arch| {
+            if (std.mem.eql(u8, arch.name, name)) break try expected.append(arch);
+        } else fatal("unsupported architecture '{s}'", .{name});
+    }
+
+    if (try int(bytes, 0) != FAT_MAGIC) fatal("{s}: not a universal binary", .{path});
+    const nfat_arch = try int(bytes, 4);
+    if (nfat_arch != expected.items.len) fatal("{s}: {d} slices, expected {d}", .{ path, nfat_arch, expected.items.len });
+
+    // [start, end) of the header and of every slice seen so far.
+    var ranges = std.ArrayList([2]u64).init(arena);
+    try ranges.append(.{ 0, 8 + 20 * @as(u64, nfat_arch) });
+    for (0..nfat_arch) |i| {
+        const entry = 8 + 20 * i;
+        const cputype = try int(bytes, entry);
+        const cpusubtype = try int(bytes, entry + 4);
+        const offset: u64 = try int(bytes, entry + 8);
+        const size: u64 = try int(bytes, entry + 12);
+        const @"align" = try int(bytes, entry + 16);
+
+        const index = for (expected.items, 0..) |arch, j| {
+            if (arch.cputype == cputype) break j;
+        } else fatal("{s}: unexpected or duplicate cputype 0x{x}", .{ path, cputype });
+        const arch = expected.swapRemove(index);
+        if (@"align" != arch.@"align") fatal("{s}: {s} slice has align 2^{d}, expected 2^{d}", .{ path, arch.name, @"align", arch.@"align" });
+        if (offset % (@as(u64, 1) << @intCast(@"align")) != 0) fatal("{s}: {s} slice at {d} is not aligned to 2^{d}", .{ path, arch.name, offset, @"align" });
+        if (size == 0 or offset + size > bytes.len) fatal("{s}: {s} slice is out of bounds", .{ path, arch.name });
+        for (ranges.items) |range| {
+            if (offset < range[1] and range[0] < offset + size) fatal("{s}: {s} slice overlaps another slice or the header", .{ path, arch.name });
+        }
+        try ranges.append(.{ offset, offset + size });
+
+        const slice = bytes[@intCast(offset)..][0..@intCast(size)];
+        if (size < 32 or std.mem.readInt(u32, slice[0..4], .little) != MH_MAGIC_64) fatal("{s}: {s} slice is not a 64-bit Mach-O", .{ path, arch.name });
+        if (std.mem.readInt(u32, slice[4..8], .little) != cputype) fatal("{s}: {s} slice has a different cputype than its fat_arch", .{ path, arch.name });
+        if (std.mem.readInt(u32, slice[8..12], .little) != cpusubtype) fatal("{s}: {s} slice has a different cpusubtype than its fat_arch", .{ path, arch.name });
+    }
+}
+
+fn int(bytes: []const u8, offset: u64) !u32 {
+    if (offset + 4 > bytes.len) return error.Truncated;
+    return std.mem.readInt(u32, bytes[@intCast(offset)..][0..4], .big);
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,153 @@
+//! Writes a SHA-256 fingerprint of the contents of every framework and of
+//! `Frameworks`, `include` and `lib` as a whole, so build steps can depend on
+//! one small file per subtree instead of on every file in it. Paths, link
+//! targets, executable bits and contents are hashed the way the package
+//! manager hashes the package.
+//!
+//! Usage: fingerprint <output-dir> <sdk-root>
+
+const std = @import("std");
+const Sha256 = std.crypto.hash.sha2.Sha256;
+
+const top_dirs = [_][]const u8{ "Frameworks", "include", "lib" };
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 3) fatal("usage: {s} <output-dir> <sdk-root>", .{args[0]});
+    var out = try std.fs.cwd().makeOpenPath(args[1], .{});
+    defer out.close();
+    var root = try std.fs.cwd().openDir(args[2], .{});
+    defer root.close();
+    try fingerprint(arena, root, out);
+}
+
+/// Writes `<subtree>.sha256` into `out` for every framework of the SDK at
+/// `root` and for its top-level directories.
+pub fn fingerprint(arena: std.mem.Allocator, root: std.fs.Dir, out: std.fs.Dir) !void {
+    try out.makePath("Frameworks");
+    var link_buf: [std.fs.max_path_bytes]u8 = undefined;
+    for (top_dirs) |top| {
+        var paths = std.ArrayList([]const u8).init(arena);
+        var kinds = std.StringHashMap(std.fs.File.Kind).init(arena);
+        if (root.openDir(top, .{ .iterate = true })) |dir_const| {
+            var dir = dir_const;
+            defer dir.close();
+            var walker = try dir.walk(arena);
+            defer walker.deinit();
+            while (try walker.next()) |entry| switch (entry.kind) {
+                .file, .sym_link => {
+                    const path = try std.fs.path.join(arena, &.{ top, entry.path });
+                    try paths.append(path);
+                    try kinds.put(path, entry.kind);
+                },
+                else => {},
+            };
+        } else |err| switch (err) {
+            error.FileNotFound => {},
+            else => return err,
+        }
+        std.mem.sort([]const u8, paths.items, {}, lessThan);
+
+        var top_hasher = Sha256.init(.{});
+        var frameworks = std.StringArrayHashMap(Sha256).init(arena);
+        for (paths.items) |path| {
+            var hasher = Sha256.init(.{});
+            hasher.update(path);
+            if (kinds.get(path).? == .sym_link) {
+                hasher.update(try root.readLink(path, &link_buf));
+            } else {
+                const file = try root.openFile(path, .{});
+                defer file.close();
+                const executable = (try file.stat()).mode & 0o100 != 0;
+                const contents = try file.readToEndAlloc(arena, 1 << 30);
+                defer arena.free(contents);
+                hasher.update(&.{ 0, @intFromBool(executable) });
+                hasher.update(contents);
+            }
+            var digest: [Sha256.digest_length]u8 = undefined;
+            hasher.final(&digest);
+            top_hasher.update(&digest);
+
+            if (!std.mem.eql(u8, top, "Frameworks")) continue;
+            const gop = try frameworks.getOrPut(frameworkName(path) orelse continue);
+            if (!gop.found_existing) gop.value_ptr.* = Sha256.init(.{});
+            gop.value_ptr.update(&digest);
+        }
+
+        try writeDigest(out, top, &top_hasher);
+        for (frameworks.keys(), frameworks.values()) |name, *hasher| try writeDigest(out, name, hasher);
+    }
+}
+
+/// `Frameworks/<Name>.framework` for a path inside a framework.
+fn frameworkName(path: []const u8) ?[]const u8 {
+    const first = std.mem.indexOfScalar(u8, path, '/') orelse return null;
+    const second = std.mem.indexOfScalarPos(u8, path, first + 1, '/') orelse return null;
+    return path[0..second];
+}
+
+fn writeDigest(out: std.fs.Dir, name: []const u8, hasher: *Sha256) !void {
+    var digest: [Sha256.digest_length]u8 = undefined;
+    hasher.final(&digest);
+    var buf: [Sha256.digest_length * 2 + 1]u8 = undefined;
+    const text = try std.fmt.bufPrint(&buf, "{s}\n", .{std.fmt.fmtSliceHexLower(&digest)});
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const path = try std.fmt.bufPrint(&path_buf, "{s}.sha256", .{name});
+    try out.writeFile(.{ .sub_path = path, .data = text });
+}
+
+fn lessThan(_: void, a: []const u8, b: []const u8) bool {
+    return std.mem.lessThan(u8, a, b);
+}
+
+test "touching one framework changes only its fingerprint and the aggregate" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    const files = [_][2][]const u8{
+        .{ "sdk/Frameworks/Metal.framework/Headers/Metal.h", "#import <Metal/MTLDevice.h>\n" },
+        .{ "sdk/Frameworks/Metal.framework/Metal.tbd", "install-name: Metal\n" },
+        .{ "sdk/Frameworks/AppKit.framework/Headers/AppKit.h", "#import <Foundation/Foundation.h>\n" },
+        .{ "sdk/include/stdio.h", "int printf(const char *, ...);\n" },
+        .{ "sdk/lib/libobjc.tbd", "install-name: libobjc\n" },
+    };
+    for (files) |file| {
+        try tmp.dir.makePath(std.fs.path.dirname(file[0]).?);
+        try tmp.dir.writeFile(.{ .sub_path = file[0], .data = file[1] });
+    }
+    var root = try tmp.dir.openDir("sdk", .{});
+    defer root.close();
+
+    var before = try tmp.dir.makeOpenPath("before", .{});
+    defer before.close();
+    try fingerprint(arena, root, before);
+    try tmp.dir.writeFile(.{ .sub_path = "sdk/Frameworks/Metal.framework/Headers/Metal.h", .data = "#import <Metal/MTLBuffer.h>\n" });
+    var after = try tmp.dir.makeOpenPath("after", .{});
+    defer after.close();
+    try fingerprint(arena, root, after);
+
+    const Expectation = struct { []const u8, bool };
+    for ([_]Expectation{
+        .{ "Frameworks/Metal.framework.sha256", true },
+        .{ "Frameworks.sha256", true },
+        .{ "Frameworks/AppKit.framework.sha256", false },
+        .{ "include.sha256", false },
+        .{ "lib.sha256", false },
+    }) |expectation| {
+        const old = try before.readFileAlloc(arena, expectation[0], 1024);
+        const new = try after.readFileAlloc(arena, expectation[0], 1024);
+        try std.testing.expectEqual(expectation[1], !std.mem.eql(u8, old, new));
+    }
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,122 @@
+//! Checks at build level that the SDK fingerprints invalidate only what
+//! they should: a consumer project depends on a copy of this package with
+//! two fixture frameworks and has a step whose only input is the
+//! fingerprint of `X.framework`. Changing a header of `Y.framework` or
+//! adding a file to it must leave that step cached; changing a header of
+//! `X.framework` must rerun it.
+//!
+//! Usage: fingerprint_cache_check <work-dir> <zig-exe> <package-root>
+
+const std = @import("std");
+
+const consumer_build_zig =
+    \\const std = @import("std");
+    \\const macos_sdk = @import("macos_sdk");
+    \\
+    \\pub fn build(b: *std.Build) void {
+    \\    const sdk = b.dependency("macos_sdk", .{});
+    \\    // Appends a line to runs.txt whenever it is not cached.
+    \\    const run = b.addSystemCommand(&.{ "sh", "-c", "echo run >> runs.txt" });
+    \\    run.setCwd(b.path("."));
+    \\    run.expectExitCode(0);
+    \\    run.addFileInput(macos_sdk.sdkFingerprint(sdk.builder, "Frameworks/X.framework"));
+    \\    b.getInstallStep().dependOn(&run.step);
+    \\}
+    \\
+;
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 4) fatal("usage: {s} <work-dir> <zig-exe> <package-root>", .{args[0]});
+    const zig_exe = args[2];
+    var work = try std.fs.cwd().makeOpenPath(args[1], .{});
+    defer work.close();
+    // Start from scratch, so the first build is never cached.
+    for ([_][]const u8{ "sdk", "consumer" }) |name| try work.deleteTree(name);
+
+    var package = try std.fs.cwd().openDir(args[3], .{});
+    defer package.close();
+    var sdk = try work.makeOpenPath("sdk", .{});
+    defer sdk.close();
+    for ([_][]const u8{ "build.zig", "build.zig.zon" }) |name| try package.copyFile(name, sdk, name, .{});
+    {
+        var tools = try package.openDir("tools", .{ .iterate = true });
+        defer tools.close();
+        var sdk_tools = try sdk.makeOpenPath("tools", .{});
+        defer sdk_tools.close();
+        var it = tools.iterate();
+        while (try it.next()) |entry| {
+            if (entry.kind == .file) try tools.copyFile(entry.name, sdk_tools, entry.name, .{});
+        }
+    }
+    try writeFile(sdk, "Frameworks/X.framework/Headers/X.h", "int x(void);\n");
+    try writeFile(sdk, "Frameworks/Y.framework/Headers/Y.h", "int y(void);\n");
+    try sdk.makePath("include");
+    try sdk.makePath("lib");
+
+    var consumer = try work.makeOpenPath("consumer", .{});
+    defer consumer.close();
+    try writeFile(consumer, "build.zig", consumer_build_zig);
+    // The upper half of a package fingerprint is the CRC-32 of its name.
+    const fingerprint = @as(u64, std.hash.Crc32.hash("fingerprint_consumer")) << 32 | 1;
+    try writeFile(consumer, "build.zig.zon", try std.fmt.allocPrint(arena,
+        \\.{{
+        \\    .name = .fingerprint_consumer,
+        \\    .fingerprint = 0x{x},
+        \\    .version = "0.0.0",
+        \\    .dependencies = .{{ .macos_sdk = .{{ .path = "../sdk" }} }},
+        \\    .paths = .{{""}},
+        \\}}
+        \\
+    , .{fingerprint}));
+    const consumer_path = try std.fs.path.join(arena, &.{ args[1], "consumer" });
+
+    try build(arena, zig_exe, consumer_path);
+    try expectRuns(consumer, 1, "the first build");
+
+    try writeFile(sdk, "Frameworks/Y.framework/Headers/Y.h", "int y(int);\nint y2(void);\n");
+    try build(arena, zig_exe, consumer_path);
+    try expectRuns(consumer, 1, "changing a header of Y.framework");
+
+    try writeFile(sdk, "Frameworks/Y.framework/Headers/Y2.h", "int y3(void);\n");
+    try build(arena, zig_exe, consumer_path);
+    try expectRuns(consumer, 1, "adding a header to Y.framework");
+
+    try writeFile(sdk, "Frameworks/X.framework/Headers/X.h", "int x(int);\nint x2(void);\n");
+    try build(arena, zig_exe, consumer_path);
+    try expectRuns(consumer, 2, "changing a header of X.framework");
+}
+
+fn build(arena: std.mem.Allocator, zig_exe: []const u8, cwd: []const u8) !void {
+    const result = try std.process.Child.run(.{
+        .allocator = arena,
+        .argv = &.{ zig_exe, "build" },
+        .cwd = cwd,
+        .max_output_bytes = 1 << 20,
+    });
+    switch (result.term) {
+        .Exited => |code| if (code == 0) return,
+        else => {},
+    }
+    fatal("zig build in '{s}' failed:\n{s}", .{ cwd, result.stderr });
+}
+
+fn expectRuns(consumer: std.fs.Dir, expected: usize, after: []const u8) !void {
+    var buf: [256]u8 = undefined;
+    const runs = std.mem.count(u8, try consumer.readFile("runs.txt", &buf), "\n");
+    if (runs != expected) fatal("after {s}, the consumer of X.framework ran {d} times, expected {d}", .{ after, runs, expected });
+}
+
+fn writeFile(dir: std.fs.Dir, sub_path: []const u8, data: []const u8) !void {
+    if (std.fs.path.dirname(sub_path)) |parent| try dir.makePath(parent);
+    try dir.writeFile(.{ .sub_path = sub_path, .data = data });
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,132 @@
+//! Lexical helpers shared by the tools that scan the SDK headers without a
+//! preprocessor, and the depfile they write.
+
+const std = @import("std");
+
+/// Removes comments and preprocessor directives, keeping string literals.
+pub fn stripComments(arena: std.mem.Allocator, src: []const u8) ![]const u8 {
+    var out = std.ArrayList(u8).init(arena);
+    var line_start = true;
+    var i: usize = 0;
+    while (i < src.len) {
+        const c = src[i];
+        if (line_start and c == '#') {
+            while (i < src.len and !(src[i] == '\n' and src[i - 1] != '\\')) i += 1;
+            continue;
+        }
+        if (std.mem.startsWith(u8, src[i..], "//")) {
+            i = std.mem.indexOfScalarPos(u8, src, i, '\n') orelse src.len;
+            continue;
+        }
+        if (std.mem.startsWith(u8, src[i..], "/*")) {
+            const end = std.mem.indexOfPos(u8, src, i + 2, "*/") orelse src.len;
+            i = @min(end + 2, src.len);
+            try out.append(' ');
+            continue;
+        }
+        if (c == '"') {
+            const start = i;
+            i += 1;
+            while (i < src.len and src[i] != '"' and src[i] != '\n') : (i += 1) {
+                if (src[i] == '\\') i += 1;
+            }
+            i = @min(i + 1, src.len);
+            try out.appendSlice(src[start..i]);
+            line_start = false;
+            continue;
+        }
+        try out.append(c);
+        line_start = c == '\n' or (line_start and (c == ' ' or c == '\t'));
+        i += 1;
+    }
+    return out.items;
+}
+
+pub fn startsWithKeyword(text: []const u8, keyword: []const u8) bool {
+    return std.mem.startsWith(u8, text, keyword) and
+        (text.len == keyword.len or !isIdentifierChar(text[keyword.len]));
+}
+
+pub fn isIdentifierChar(c: u8) bool {
+    return std.ascii.isAlphanumeric(c) or c == '_';
+}
+
+/// The identifier at the start of `text`, if any.
+pub fn identifier(text: []const u8) ?[]const u8 {
+    if (text.len == 0 or std.ascii.isDigit(text[0])) return null;
+    var end: usize = 0;
+    while (end < text.len and isIdentifierChar(text[end])) end += 1;
+    return if (end == 0) null else text[0..end];
+}
+
+/// The start of the identifier at the end of `text`, if any.
+pub fn trailingIdentifier(text: []const u8) ?usize {
+    var start = text.len;
+    while (start > 0 and isIdentifierChar(text[start - 1])) start -= 1;
+    if (start == text.len or std.ascii.isDigit(text[start])) return null;
+    return start;
+}
+
+/// Index of the bracket closing the one at `open`.
+pub fn matching(text: []const u8, open: usize, left: u8, right: u8) ?usize {
+    var depth: usize = 0;
+    for (text[open..], open..) |c, i| {
+        if (c == left) depth += 1;
+        if (c == right) {
+            depth -= 1;
+            if (depth == 0) return i;
+        }
+    }
+    return null;
+}
+
+/// Reserved `__` keywords that qualify a type instead of expanding as macros.
+const type_qualifiers = std.StaticStringMap(void).initComptime(.{
+    .{"__nullable"},
+    .{"__nonnull"},
+    .{"__kindof"},
+    .{"__strong"},
+    .{"__weak"},
+    .{"__unsafe_unretained"},
+    .{"__autoreleasing"},
+    .{"__covariant"},
+    .{"__contravariant"},
+});
+
+/// All-caps macros, plus `__attribute__` and the other `__` keywords that are
+/// not type qualifiers.
+pub fn isMacroName(word: []const u8) bool {
+    if (std.mem.startsWith(u8, word, "__") and !type_qualifiers.has(word)) return true;
+    if (std.mem.indexOfScalar(u8, word, '_') == null) return false;
+    for (word) |c| {
+        if (!std.ascii.isUpper(c) and !std.ascii.isDigit(c) and c != '_') return false;
+    }
+    return true;
+}
+
+pub fn contains(haystack: []const []const u8, needle: []const u8) bool {
+    for (haystack) |item| {
+        if (std.mem.eql(u8, item, needle)) return true;
+    }
+    return false;
+}
+
+pub fn lessThan(_: void, a: []const u8, b: []const u8) bool {
+    return std.mem.lessThan(u8, a, b);
+}
+
+/// Writes a Makefile-style depfile listing `inputs` as the prerequisites of
+/// `output_path`, so the build system reruns the tool when one changes.
+pub fn writeDepFile(arena: std.mem.Allocator, dep_path: []const u8, output_path: []const u8, inputs: []const []const u8) !void {
+    var dep = std.ArrayList(u8).init(arena);
+    try dep.writer().print("{s}:", .{output_path});
+    for (inputs) |input| {
+        try dep.appendSlice(" \\\n  ");
+        for (input) |c| {
+            if (c == ' ') try dep.append('\\');
+            try dep.append(c);
+        }
+    }
+    try dep.append('\n');
+    try std.fs.cwd().writeFile(.{ .sub_path = dep_path, .data = dep.items });
+}
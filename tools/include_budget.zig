@@ -0,0 +1,242 @@
+//! Sums the bytes of SDK headers each translation unit of a compile step
+//! includes, from the include trees clang writes with `-H`, and reports the
+//! translation units over budget with the outermost SDK includes responsible,
+//! e.g. `<Cocoa/Cocoa.h>`, broken down by framework.
+//!
+//! Each translation unit is passed with the include tree of its own compile,
+//! so a tree is never appended to or left over from a removed source.
+//!
+//! Usage: include_budget <sdk-frameworks-dir> <sdk-include-dir> <max-bytes> <warn|fail> (<tu> <include-tree>)...
+
+const std = @import("std");
+
+const Culprit = struct {
+    bytes: u64 = 0,
+    groups: std.StringArrayHashMapUnmanaged(u64) = .{},
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 5 or (args.len - 5) % 2 != 0) {
+        fatal("usage: {s} <sdk-frameworks-dir> <sdk-include-dir> <max-bytes> <warn|fail> (<tu> <include-tree>)...", .{args[0]});
+    }
+    const frameworks_dir = try std.fs.cwd().realpathAlloc(arena, args[1]);
+    const include_dir = try std.fs.cwd().realpathAlloc(arena, args[2]);
+    const max_bytes = try std.fmt.parseInt(u64, args[3], 10);
+    const fail = std.mem.eql(u8, args[4], "fail");
+
+    const stdout = std.io.getStdOut().writer();
+    var sizes = std.StringHashMap(?u64).init(arena);
+    var over: usize = 0;
+    var i: usize = 5;
+    while (i < args.len) : (i += 2) {
+        const tu = args[i];
+        // A compile replayed from zig's own cache does not write the tree.
+        const tree = std.fs.cwd().readFileAlloc(arena, args[i + 1], 1 << 30) catch |err| {
+            std.log.warn("skipping '{s}': {s}", .{ tu, @errorName(err) });
+            continue;
+        };
+        const report = try analyze(arena, tree, frameworks_dir, include_dir, &sizes);
+        if (report.total <= max_bytes) continue;
+        over += 1;
+        try stdout.print("{s}: {s} includes {} of SDK headers, budget {}\n", .{
+            if (fail) "error" else "warning",
+            tu,
+            std.fmt.fmtIntSizeBin(report.total),
+            std.fmt.fmtIntSizeBin(max_bytes),
+        });
+        const shown_culprits = @min(5, report.culprits.count());
+        for (report.culprits.keys()[0..shown_culprits], report.culprits.values()[0..shown_culprits]) |culprit_name, culprit| {
+            try stdout.print("  {s}: {}", .{ culprit_name, std.fmt.fmtIntSizeBin(culprit.bytes) });
+            const shown = @min(4, culprit.groups.count());
+            for (culprit.groups.keys()[0..shown], culprit.groups.values()[0..shown], 0..) |group_name, bytes, j| {
+                try stdout.print("{s}{s} {}", .{ if (j == 0) " (" else ", ", group_name, std.fmt.fmtIntSizeBin(bytes) });
+            }
+            try stdout.writeAll(if (shown > 0) ")\n" else "\n");
+        }
+    }
+    try stdout.print("include budget: {d} of {d} TUs over {}\n", .{ over, (args.len - 5) / 2, std.fmt.fmtIntSizeBin(max_bytes) });
+    if (fail and over > 0) std.process.exit(1);
+}
+
+const Report = struct {
+    /// Bytes of distinct SDK headers.
+    total: u64 = 0,
+    /// Bytes per outermost SDK include, largest first, each broken down by
+    /// group, largest first.
+    culprits: std.StringArrayHashMapUnmanaged(Culprit) = .{},
+};
+
+/// Sums the SDK headers in the include tree clang writes with `-H`, one
+/// line of dots and a path per header, each header counted once and
+/// charged to the outermost SDK include it was reached through. `sizes`
+/// caches header sizes by real path across translation units.
+fn analyze(
+    arena: std.mem.Allocator,
+    tree: []const u8,
+    frameworks_dir: []const u8,
+    include_dir: []const u8,
+    sizes: *std.StringHashMap(?u64),
+) !Report {
+    var report: Report = .{};
+    var seen = std.StringHashMap(void).init(arena);
+    // The include chain of the current header; null entries are not part
+    // of the SDK.
+    var stack = std.ArrayList(?[]const u8).init(arena);
+
+    var lines = std.mem.tokenizeScalar(u8, tree, '\n');
+    while (lines.next()) |line| {
+        const depth = std.mem.indexOfNone(u8, line, ".") orelse continue;
+        if (depth == 0 or line[depth] != ' ') continue;
+        const path = std.fs.cwd().realpathAlloc(arena, line[depth + 1 ..]) catch continue;
+        stack.shrinkRetainingCapacity(@min(stack.items.len, depth - 1));
+        const rel = relativeTo(frameworks_dir, path) orelse relativeTo(include_dir, path);
+        const header = if (rel) |r| try includeName(arena, r, relativeTo(frameworks_dir, path) != null) else null;
+        try stack.append(header);
+        if (header == null or (try seen.getOrPut(path)).found_existing) continue;
+
+        const size = sizes.get(path) orelse b: {
+            const size: ?u64 = if (std.fs.cwd().statFile(path)) |stat| stat.size else |_| null;
+            try sizes.put(path, size);
+            break :b size;
+        } orelse continue;
+        report.total += size;
+
+        var culprit_name = header.?;
+        for (stack.items) |outer| if (outer) |o| {
+            culprit_name = o;
+            break;
+        };
+        const culprit = try report.culprits.getOrPutValue(arena, culprit_name, .{});
+        culprit.value_ptr.bytes += size;
+        const group_name = group(arena, rel.?, relativeTo(frameworks_dir, path) != null) catch continue;
+        (try culprit.value_ptr.groups.getOrPutValue(arena, group_name, 0)).value_ptr.* += size;
+    }
+
+    const SortContext = struct {
+        values: []const Culprit,
+        pub fn lessThan(ctx: @This(), a: usize, b: usize) bool {
+            return ctx.values[a].bytes > ctx.values[b].bytes;
+        }
+    };
+    report.culprits.sort(SortContext{ .values = report.culprits.values() });
+    for (report.culprits.values()) |*culprit| {
+        const GroupContext = struct {
+            values: []const u64,
+            pub fn lessThan(ctx: @This(), a: usize, b: usize) bool {
+                return ctx.values[a] > ctx.values[b];
+            }
+        };
+        culprit.groups.sort(GroupContext{ .values = culprit.groups.values() });
+    }
+    return report;
+}
+
+/// The include spelling of an SDK header: `<HIToolbox/Menus.h>` for a header
+/// of a framework, even a nested one, and `<dispatch/dispatch.h>` otherwise.
+fn includeName(arena: std.mem.Allocator, rel: []const u8, in_frameworks: bool) ![]const u8 {
+    if (!in_frameworks) return std.fmt.allocPrint(arena, "<{s}>", .{rel});
+    const marker = ".framework/";
+    const end = std.mem.lastIndexOf(u8, rel, marker) orelse return std.fmt.allocPrint(arena, "<{s}>", .{rel});
+    const start = if (std.mem.lastIndexOfScalar(u8, rel[0..end], '/')) |slash| slash + 1 else 0;
+    const inner = rel[end + marker.len ..];
+    const headers = std.mem.indexOf(u8, inner, "Headers/") orelse return std.fmt.allocPrint(arena, "<{s}>", .{rel});
+    return std.fmt.allocPrint(arena, "<{s}/{s}>", .{ rel[start..end], inner[headers + "Headers/".len ..] });
+}
+
+/// The framework ("ApplicationServices/HIServices") or `include/`
+/// subdirectory ("include/dispatch") a header belongs to.
+fn group(arena: std.mem.Allocator, rel: []const u8, in_frameworks: bool) ![]const u8 {
+    if (!in_frameworks) {
+        const first = std.mem.indexOfScalar(u8, rel, '/') orelse return "include";
+        return std.fmt.allocPrint(arena, "include/{s}", .{rel[0..first]});
+    }
+    var result = std.ArrayList(u8).init(arena);
+    var components = std.mem.tokenizeScalar(u8, rel, '/');
+    while (components.next()) |component| {
+        if (!std.mem.endsWith(u8, component, ".framework")) continue;
+        if (result.items.len > 0) try result.append('/');
+        try result.appendSlice(component[0 .. component.len - ".framework".len]);
+    }
+    return result.items;
+}
+
+fn relativeTo(dir: []const u8, path: []const u8) ?[]const u8 {
+    if (!std.mem.startsWith(u8, path, dir)) return null;
+    if (path.len <= dir.len or path[dir.len] != '/') return null;
+    return path[dir.len + 1 ..];
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
+
+test "analyze an include tree" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const headers = [_]struct { []const u8, usize }{
+        .{ "Frameworks/Cocoa.framework/Headers/Cocoa.h", 10 },
+        .{ "Frameworks/AppKit.framework/Headers/AppKit.h", 100 },
+        .{ "Frameworks/ApplicationServices.framework/Frameworks/HIServices.framework/Headers/Icons.h", 1000 },
+        .{ "include/dispatch/dispatch.h", 20 },
+        .{ "project/leaf.h", 5000 },
+    };
+    for (headers) |header| {
+        try tmp.dir.makePath(std.fs.path.dirname(header[0]).?);
+        const data = try arena.alloc(u8, header[1]);
+        @memset(data, ' ');
+        try tmp.dir.writeFile(.{ .sub_path = header[0], .data = data });
+    }
+    const root = try tmp.dir.realpathAlloc(arena, ".");
+    const frameworks = try std.fs.path.join(arena, &.{ root, "Frameworks" });
+    const include = try std.fs.path.join(arena, &.{ root, "include" });
+
+    // The project header is not charged, AppKit.h only once, and the nested
+    // headers to the umbrella that pulled them in.
+    const tree = try std.fmt.allocPrint(arena,
+        \\. {0s}/project/leaf.h
+        \\.. {0s}/Frameworks/Cocoa.framework/Headers/Cocoa.h
+        \\... {0s}/Frameworks/AppKit.framework/Headers/AppKit.h
+        \\... {0s}/Frameworks/ApplicationServices.framework/Frameworks/HIServices.framework/Headers/Icons.h
+        \\. {0s}/include/dispatch/dispatch.h
+        \\. {0s}/Frameworks/AppKit.framework/Headers/AppKit.h
+        \\. {0s}/missing.h
+        \\Multiple include guards may be useful for:
+        \\{0s}/project/leaf.h
+        \\
+    , .{root});
+    var sizes = std.StringHashMap(?u64).init(arena);
+    const report = try analyze(arena, tree, frameworks, include, &sizes);
+
+    try std.testing.expectEqual(1130, report.total);
+    try std.testing.expectEqual(2, report.culprits.count());
+    try std.testing.expectEqualStrings("<Cocoa/Cocoa.h>", report.culprits.keys()[0]);
+    const cocoa = report.culprits.values()[0];
+    try std.testing.expectEqual(1110, cocoa.bytes);
+    try std.testing.expectEqual(3, cocoa.groups.count());
+    try std.testing.expectEqualStrings("ApplicationServices/HIServices", cocoa.groups.keys()[0]);
+    try std.testing.expectEqual(1000, cocoa.groups.values()[0]);
+    try std.testing.expectEqualStrings("AppKit", cocoa.groups.keys()[1]);
+    try std.testing.expectEqualStrings("Cocoa", cocoa.groups.keys()[2]);
+    try std.testing.expectEqualStrings("<dispatch/dispatch.h>", report.culprits.keys()[1]);
+    try std.testing.expectEqualStrings("include/dispatch", report.culprits.values()[1].groups.keys()[0]);
+}
+
+test includeName {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    try std.testing.expectEqualStrings("<HIToolbox/Menus.h>", try includeName(arena, "Carbon.framework/Frameworks/HIToolbox.framework/Headers/Menus.h", true));
+    try std.testing.expectEqualStrings("<AppKit/NSView.h>", try includeName(arena, "AppKit.framework/Headers/NSView.h", true));
+    try std.testing.expectEqualStrings("<os/log.h>", try includeName(arena, "os/log.h", false));
+}
@@ -0,0 +1,669 @@
+//! Reports what a built Mach-O costs dyld at launch, resolved against the
+//! `.tbd` stubs of this package: the images it loads directly and through
+//! re-exports, the symbols it imports from each dylib, and how its fixups
+//! are encoded (chained fixups or legacy rebase and bind opcodes). Dylibs
+//! nothing is imported from are flagged for removal, and umbrellas whose
+//! imports all come from some of the images they re-export are flagged for
+//! linking those images directly. Fat binaries are reported per slice.
+//!
+//! Usage: launch_cost <binary> <sdk-root> [--fail-unused]
+
+const std = @import("std");
+const tbd = @import("tbd.zig");
+
+const FAT_MAGIC = 0xcafebabe;
+const MH_MAGIC_64 = 0xfeedfacf;
+const LC_REQ_DYLD = 0x80000000;
+const LC_SEGMENT_64 = 0x19;
+const LC_LOAD_DYLIB = 0xc;
+const LC_LOAD_WEAK_DYLIB = 0x18 | LC_REQ_DYLD;
+const LC_REEXPORT_DYLIB = 0x1f | LC_REQ_DYLD;
+const LC_LAZY_LOAD_DYLIB = 0x20;
+const LC_LOAD_UPWARD_DYLIB = 0x23 | LC_REQ_DYLD;
+const LC_DYLD_INFO = 0x22;
+const LC_DYLD_INFO_ONLY = 0x22 | LC_REQ_DYLD;
+const LC_DYLD_CHAINED_FIXUPS = 0x34 | LC_REQ_DYLD;
+const CPU_TYPE_ARM64 = 0x0100000c;
+const CPU_TYPE_X86_64 = 0x01000007;
+const DYLD_CHAINED_PTR_START_NONE = 0xffff;
+const BIND_SYMBOL_FLAGS_WEAK_IMPORT = 0x1;
+
+const Dylib = struct {
+    install_name: []const u8,
+    kind: Kind,
+    /// Distinct symbols imported from the dylib.
+    imports: std.StringArrayHashMapUnmanaged(void) = .{},
+    weak_imports: usize = 0,
+    binds: usize = 0,
+
+    const Kind = enum { load, weak, reexport, lazy, upward };
+};
+
+const Segment = struct {
+    fileoff: u64,
+    filesize: u64,
+};
+
+const Fixups = struct {
+    encoding: enum { none, chained, opcodes } = .none,
+    rebases: usize = 0,
+    binds: usize = 0,
+    weak_binds: usize = 0,
+    lazy_binds: usize = 0,
+};
+
+/// The stub of every install name in the package.
+const Stubs = struct {
+    docs: std.StringHashMap(tbd.Document),
+    exports: std.StringHashMap(std.StringHashMapUnmanaged(void)),
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 3 or args.len > 4) fatal("usage: {s} <binary> <sdk-root> [--fail-unused]", .{args[0]});
+    const fail_unused = args.len == 4 and std.mem.eql(u8, args[3], "--fail-unused");
+    const bytes = try std.fs.cwd().readFileAlloc(arena, args[1], 1 << 30);
+
+    var stubs: Stubs = .{
+        .docs = std.StringHashMap(tbd.Document).init(arena),
+        .exports = std.StringHashMap(std.StringHashMapUnmanaged(void)).init(arena),
+    };
+    try loadStubs(arena, args[2], &stubs);
+
+    var stdout_buffer = std.io.bufferedWriter(std.io.getStdOut().writer());
+    const stdout = stdout_buffer.writer();
+    try stdout.print("{s}\n", .{args[1]});
+    var unused: usize = 0;
+    if (bytes.len >= 4 and std.mem.readInt(u32, bytes[0..4], .big) == FAT_MAGIC) {
+        const nfat_arch = try int(u32, .big, bytes, 4);
+        for (0..nfat_arch) |i| {
+            const offset = try int(u32, .big, bytes, 8 + i * 20 + 8);
+            const size = try int(u32, .big, bytes, 8 + i * 20 + 12);
+            if (@as(usize, offset) + size > bytes.len) fatal("slice {d} is out of bounds", .{i});
+            unused += try report(arena, stdout, &stubs, bytes[offset..][0..size]);
+        }
+    } else {
+        unused += try report(arena, stdout, &stubs, bytes);
+    }
+    try stdout_buffer.flush();
+    if (fail_unused and unused > 0) fatal("{d} linked dylibs are unused", .{unused});
+}
+
+fn loadStubs(arena: std.mem.Allocator, sdk: []const u8, stubs: *Stubs) !void {
+    var root = try std.fs.cwd().openDir(sdk, .{});
+    defer root.close();
+    for ([_][]const u8{ "Frameworks", "lib" }) |top| {
+        var dir = try root.openDir(top, .{ .iterate = true });
+        defer dir.close();
+        var walker = try dir.walk(arena);
+        defer walker.deinit();
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file or !std.mem.endsWith(u8, entry.basename, ".tbd")) continue;
+            const src = try dir.readFileAlloc(arena, entry.path, 1 << 30);
+            const docs = tbd.parse(arena, src) catch |err| {
+                std.log.warn("skipping '{s}/{s}': {s}", .{ top, entry.path, @errorName(err) });
+                continue;
+            };
+            for (docs) |doc| try stubs.docs.put(doc.install_name, doc);
+        }
+    }
+}
+
+/// Reports one thin Mach-O and returns the number of unused dylibs.
+fn report(arena: std.mem.Allocator, out: anytype, stubs: *Stubs, bytes: []const u8) !usize {
+    if (try int(u32, .little, bytes, 0) != MH_MAGIC_64) fatal("not a 64-bit Mach-O", .{});
+    const cputype = try int(u32, .little, bytes, 4);
+    const target = switch (cputype) {
+        CPU_TYPE_ARM64 => "arm64-macos",
+        CPU_TYPE_X86_64 => "x86_64-macos",
+        else => fatal("unsupported CPU type 0x{x}", .{cputype}),
+    };
+
+    var dylibs = std.ArrayList(Dylib).init(arena);
+    var segments = std.ArrayList(Segment).init(arena);
+    var chained_fixups: ?[]const u8 = null;
+    var dyld_info: ?usize = null;
+    const ncmds = try int(u32, .little, bytes, 16);
+    var offset: usize = 32;
+    for (0..ncmds) |_| {
+        const cmd = try int(u32, .little, bytes, offset);
+        const cmdsize = try int(u32, .little, bytes, offset + 4);
+        switch (cmd) {
+            LC_SEGMENT_64 => try segments.append(.{
+                .fileoff = try int(u64, .little, bytes, offset + 40),
+                .filesize = try int(u64, .little, bytes, offset + 48),
+            }),
+            LC_LOAD_DYLIB, LC_LOAD_WEAK_DYLIB, LC_REEXPORT_DYLIB, LC_LAZY_LOAD_DYLIB, LC_LOAD_UPWARD_DYLIB => {
+                const name_offset = try int(u32, .little, bytes, offset + 8);
+                try dylibs.append(.{
+                    .install_name = try cstring(bytes, offset + name_offset),
+                    .kind = switch (cmd) {
+                        LC_LOAD_WEAK_DYLIB => .weak,
+                        LC_REEXPORT_DYLIB => .reexport,
+                        LC_LAZY_LOAD_DYLIB => .lazy,
+                        LC_LOAD_UPWARD_DYLIB => .upward,
+                        else => .load,
+                    },
+                });
+            },
+            LC_DYLD_CHAINED_FIXUPS => {
+                const dataoff = try int(u32, .little, bytes, offset + 8);
+                const datasize = try int(u32, .little, bytes, offset + 12);
+                if (@as(usize, dataoff) + datasize > bytes.len) return error.Truncated;
+                chained_fixups = bytes[dataoff..][0..datasize];
+            },
+            LC_DYLD_INFO, LC_DYLD_INFO_ONLY => dyld_info = offset,
+            else => {},
+        }
+        offset += cmdsize;
+    }
+
+    var fixups: Fixups = .{};
+    if (chained_fixups) |data| {
+        fixups.encoding = .chained;
+        try readChainedFixups(arena, bytes, data, segments.items, dylibs.items, &fixups);
+    } else if (dyld_info) |info| {
+        fixups.encoding = .opcodes;
+        const streams = [_]struct { usize, BindStream }{
+            .{ 16, .normal },
+            .{ 24, .weak },
+            .{ 32, .lazy },
+        };
+        fixups.rebases = try countRebases(try linkedit(bytes, info + 8));
+        for (streams) |stream| {
+            try readBinds(arena, try linkedit(bytes, info + stream[0]), stream[1], dylibs.items, &fixups);
+        }
+    }
+
+    // Every image dyld maps for the dylibs, following re-exports.
+    var images = std.StringArrayHashMap(void).init(arena);
+    for (dylibs.items) |dylib| try closure(stubs, target, dylib.install_name, &images);
+
+    try out.print("\n{s}: {d} dylibs linked, {d} images loaded with their re-exports\n", .{
+        target[0 .. target.len - "-macos".len],
+        dylibs.items.len,
+        images.count(),
+    });
+    switch (fixups.encoding) {
+        .none => try out.writeAll("  fixups: none\n"),
+        .chained => try out.print("  fixups: chained, {d} rebases, {d} binds\n", .{ fixups.rebases, fixups.binds }),
+        .opcodes => try out.print("  fixups: legacy opcodes, {d} rebases, {d} binds, {d} lazy binds, {d} weak binds\n", .{
+            fixups.rebases,
+            fixups.binds,
+            fixups.lazy_binds,
+            fixups.weak_binds,
+        }),
+    }
+
+    var unused: usize = 0;
+    var advice = std.ArrayList(u8).init(arena);
+    for (dylibs.items) |dylib| {
+        const name = std.fs.path.basename(dylib.install_name);
+        const kind = if (dylib.kind == .load) "" else try std.fmt.allocPrint(arena, " ({s})", .{@tagName(dylib.kind)});
+        try out.print("  {s}{s}: {d} imports ({d} weak), {d} binds{s}\n", .{
+            name,
+            kind,
+            dylib.imports.count(),
+            dylib.weak_imports,
+            dylib.binds,
+            if (stubs.docs.contains(dylib.install_name)) "" else ", not in the package",
+        });
+
+        var reexported = std.StringArrayHashMap(void).init(arena);
+        try closure(stubs, target, dylib.install_name, &reexported);
+        if (reexported.count() > 1) {
+            // Which of the re-exported images the imports resolve to.
+            var providers = std.StringArrayHashMap(usize).init(arena);
+            var resolved: usize = 0;
+            for (dylib.imports.keys()) |symbol| {
+                for (reexported.keys()) |image| {
+                    if (!try exportsSymbol(arena, stubs, target, image, symbol)) continue;
+                    (try providers.getOrPutValue(image, 0)).value_ptr.* += 1;
+                    resolved += 1;
+                    break;
+                }
+            }
+            for (reexported.keys()[1..]) |image| {
+                try out.print("    re-exports {s}: {d} imports\n", .{ std.fs.path.basename(image), providers.get(image) orelse 0 });
+            }
+            if (dylib.imports.count() > 0 and resolved == dylib.imports.count() and
+                providers.count() < reexported.count() and !providers.contains(dylib.install_name))
+            {
+                try advice.writer().writeAll("  link ");
+                for (providers.keys(), 0..) |image, i| {
+                    try advice.writer().print("{s}{s}", .{ if (i == 0) "" else ", ", std.fs.path.basename(image) });
+                }
+                try advice.writer().print(" instead of {s}, which also loads {d} images nothing is imported from\n", .{
+                    name,
+                    reexported.count() - providers.count(),
+                });
+            }
+        }
+        if (dylib.imports.count() == 0 and dylib.kind != .reexport) {
+            unused += 1;
+            try advice.writer().print("  drop {s}: linked, but nothing is imported from it\n", .{name});
+        }
+    }
+    if (advice.items.len > 0) try out.print("  recommendations:\n{s}", .{advice.items});
+    return unused;
+}
+
+/// Adds `install_name` and everything it re-exports for `target` to `images`.
+fn closure(stubs: *Stubs, target: []const u8, install_name: []const u8, images: *std.StringArrayHashMap(void)) !void {
+    if ((try images.getOrPut(install_name)).found_existing) return;
+    const doc = stubs.docs.get(install_name) orelse return;
+    for (doc.reexported_libraries) |section| {
+        if (!section.hasTarget(target)) continue;
+        for (section.libraries) |library| try closure(stubs, target, library, images);
+    }
+}
+
+fn exportsSymbol(arena: std.mem.Allocator, stubs: *Stubs, target: []const u8, install_name: []const u8, symbol: []const u8) !bool {
+    const gop = try stubs.exports.getOrPut(install_name);
+    if (!gop.found_existing) {
+        gop.value_ptr.* = .{};
+        const doc = stubs.docs.get(install_name) orelse return false;
+        for ([_][]const tbd.Section{ doc.exports, doc.reexports }) |sections| {
+            for (sections) |section| {
+                if (!section.hasTarget(target)) continue;
+                for ([_][]const []const u8{ section.symbols, section.weak_symbols, section.thread_local_symbols }) |symbols| {
+                    for (symbols) |name| try gop.value_ptr.put(arena, name, {});
+                }
+                for (section.objc_classes) |name| {
+                    try gop.value_ptr.put(arena, try std.fmt.allocPrint(arena, "_OBJC_CLASS_$_{s}", .{name}), {});
+                    try gop.value_ptr.put(arena, try std.fmt.allocPrint(arena, "_OBJC_METACLASS_$_{s}", .{name}), {});
+                }
+                for (section.objc_eh_types) |name| {
+                    try gop.value_ptr.put(arena, try std.fmt.allocPrint(arena, "_OBJC_EHTYPE_$_{s}", .{name}), {});
+                }
+                for (section.objc_ivars) |name| {
+                    try gop.value_ptr.put(arena, try std.fmt.allocPrint(arena, "_OBJC_IVAR_$_{s}", .{name}), {});
+                }
+            }
+        }
+    }
+    return gop.value_ptr.contains(symbol);
+}
+
+/// Counts the imports of `LC_DYLD_CHAINED_FIXUPS` per dylib and walks the
+/// pointer chains of every page to count rebases and binds.
+fn readChainedFixups(
+    arena: std.mem.Allocator,
+    bytes: []const u8,
+    data: []const u8,
+    segments: []const Segment,
+    dylibs: []Dylib,
+    fixups: *Fixups,
+) !void {
+    const starts_offset = try int(u32, .little, data, 4);
+    const imports_offset = try int(u32, .little, data, 8);
+    const symbols_offset = try int(u32, .little, data, 12);
+    const imports_count = try int(u32, .little, data, 16);
+    const imports_format = try int(u32, .little, data, 20);
+    if (try int(u32, .little, data, 24) != 0) fatal("compressed chained fixup symbols are not supported", .{});
+
+    const Import = struct { ordinal: i64, weak: bool, name_offset: u64 };
+    const import_dylibs = try arena.alloc(?usize, imports_count);
+    for (import_dylibs, 0..) |*import_dylib, i| {
+        const import: Import = switch (imports_format) {
+            // DYLD_CHAINED_IMPORT and DYLD_CHAINED_IMPORT_ADDEND
+            1, 2 => b: {
+                const entry = try int(u32, .little, data, imports_offset + i * @as(usize, if (imports_format == 1) 4 else 8));
+                break :b .{
+                    .ordinal = @as(i8, @bitCast(@as(u8, @truncate(entry)))),
+                    .weak = entry >> 8 & 1 != 0,
+                    .name_offset = entry >> 9,
+                };
+            },
+            // DYLD_CHAINED_IMPORT_ADDEND64
+            3 => b: {
+                const entry = try int(u64, .little, data, imports_offset + i * 16);
+                break :b .{
+                    .ordinal = @as(i16, @bitCast(@as(u16, @truncate(entry)))),
+                    .weak = entry >> 16 & 1 != 0,
+                    .name_offset = entry >> 32,
+                };
+            },
+            else => fatal("unknown chained import format {d}", .{imports_format}),
+        };
+        import_dylib.* = null;
+        if (import.ordinal < 1 or import.ordinal > dylibs.len) continue;
+        const dylib = &dylibs[@intCast(import.ordinal - 1)];
+        const gop = try dylib.imports.getOrPut(arena, try cstring(data, symbols_offset + import.name_offset));
+        if (!gop.found_existing and import.weak) dylib.weak_imports += 1;
+        import_dylib.* = @intCast(import.ordinal - 1);
+    }
+
+    const seg_count = try int(u32, .little, data, starts_offset);
+    for (0..@min(seg_count, segments.len)) |seg| {
+        const seg_info_offset = try int(u32, .little, data, starts_offset + 4 + seg * 4);
+        if (seg_info_offset == 0) continue;
+        const info = @as(usize, starts_offset) + seg_info_offset;
+        const page_size = try int(u16, .little, data, info + 4);
+        const pointer_format = try int(u16, .little, data, info + 6);
+        const page_count = try int(u16, .little, data, info + 20);
+        const layout: struct { stride: u64, next_mask: u64, bind_bit: u6, ordinal_mask: u64 } = switch (pointer_format) {
+            // DYLD_CHAINED_PTR_ARM64E, _ARM64E_USERLAND
+            1, 9 => .{ .stride = 8, .next_mask = 0x7ff, .bind_bit = 62, .ordinal_mask = 0xffff },
+            // DYLD_CHAINED_PTR_ARM64E_USERLAND24
+            12 => .{ .stride = 8, .next_mask = 0x7ff, .bind_bit = 62, .ordinal_mask = 0xffffff },
+            // DYLD_CHAINED_PTR_64, _64_OFFSET
+            2, 6 => .{ .stride = 4, .next_mask = 0xfff, .bind_bit = 63, .ordinal_mask = 0xffffff },
+            else => fatal("unsupported chained pointer format {d}", .{pointer_format}),
+        };
+        for (0..page_count) |page| {
+            const page_start = try int(u16, .little, data, info + 22 + page * 2);
+            if (page_start == DYLD_CHAINED_PTR_START_NONE) continue;
+            var pos = segments[seg].fileoff + page * page_size + page_start;
+            while (true) {
+                const pointer = try int(u64, .little, bytes, pos);
+                if (pointer >> layout.bind_bit & 1 != 0) {
+                    fixups.binds += 1;
+                    const import: usize = @intCast(pointer & layout.ordinal_mask);
+                    if (import < import_dylibs.len) {
+                        if (import_dylibs[import]) |dylib| dylibs[dylib].binds += 1;
+                    }
+                } else {
+                    fixups.rebases += 1;
+                }
+                const next = pointer >> 51 & layout.next_mask;
+                if (next == 0) break;
+                pos += next * layout.stride;
+            }
+        }
+    }
+}
+
+const BindStream = enum { normal, weak, lazy };
+
+/// The rebase, bind, weak bind or lazy bind opcodes at the offset and size
+/// stored at `field` of `LC_DYLD_INFO`.
+fn linkedit(bytes: []const u8, field: usize) ![]const u8 {
+    const offset = try int(u32, .little, bytes, field);
+    const size = try int(u32, .little, bytes, field + 4);
+    if (@as(usize, offset) + size > bytes.len) return error.Truncated;
+    return bytes[offset..][0..size];
+}
+
+fn countRebases(opcodes: []const u8) !usize {
+    var count: usize = 0;
+    var i: usize = 0;
+    while (i < opcodes.len) {
+        const opcode = opcodes[i] & 0xf0;
+        const immediate = opcodes[i] & 0x0f;
+        i += 1;
+        switch (opcode) {
+            0x00 => break, // REBASE_OPCODE_DONE
+            0x10, 0x40 => {}, // SET_TYPE_IMM, ADD_ADDR_IMM_SCALED
+            0x20, 0x30 => _ = try uleb(opcodes, &i), // SET_SEGMENT_AND_OFFSET_ULEB, ADD_ADDR_ULEB
+            0x50 => count += immediate, // DO_REBASE_IMM_TIMES
+            0x60 => count += try uleb(opcodes, &i), // DO_REBASE_ULEB_TIMES
+            0x70 => { // DO_REBASE_ADD_ADDR_ULEB
+                count += 1;
+                _ = try uleb(opcodes, &i);
+            },
+            0x80 => { // DO_REBASE_ULEB_TIMES_SKIPPING_ULEB
+                count += try uleb(opcodes, &i);
+                _ = try uleb(opcodes, &i);
+            },
+            else => return error.InvalidRebaseOpcode,
+        }
+    }
+    return count;
+}
+
+fn readBinds(arena: std.mem.Allocator, opcodes: []const u8, stream: BindStream, dylibs: []Dylib, fixups: *Fixups) !void {
+    var ordinal: i64 = 0;
+    var symbol: []const u8 = "";
+    var weak = false;
+    var i: usize = 0;
+    while (i < opcodes.len) {
+        const opcode = opcodes[i] & 0xf0;
+        const immediate = opcodes[i] & 0x0f;
+        i += 1;
+        var binds: usize = 0;
+        switch (opcode) {
+            // BIND_OPCODE_DONE separates the entries of the lazy stream.
+            0x00 => if (stream == .lazy) continue else break,
+            0x10 => ordinal = immediate, // SET_DYLIB_ORDINAL_IMM
+            0x20 => ordinal = @intCast(try uleb(opcodes, &i)), // SET_DYLIB_ORDINAL_ULEB
+            0x30 => ordinal = if (immediate == 0) 0 else @as(i8, @bitCast(0xf0 | immediate)), // SET_DYLIB_SPECIAL_IMM
+            0x40 => { // SET_SYMBOL_TRAILING_FLAGS_IMM
+                symbol = try cstring(opcodes, i);
+                i += symbol.len + 1;
+                weak = immediate & BIND_SYMBOL_FLAGS_WEAK_IMPORT != 0;
+            },
+            0x50 => {}, // SET_TYPE_IMM
+            0x60, 0x70, 0x80 => _ = try uleb(opcodes, &i), // SET_ADDEND_SLEB, SET_SEGMENT_AND_OFFSET_ULEB, ADD_ADDR_ULEB
+            0x90, 0xb0 => binds = 1, // DO_BIND, DO_BIND_ADD_ADDR_IMM_SCALED
+            0xa0 => { // DO_BIND_ADD_ADDR_ULEB
+                binds = 1;
+                _ = try uleb(opcodes, &i);
+            },
+            0xc0 => { // DO_BIND_ULEB_TIMES_SKIPPING_ULEB
+                binds = try uleb(opcodes, &i);
+                _ = try uleb(opcodes, &i);
+            },
+            0xd0 => if (immediate == 0) { // THREADED, SET_BIND_ORDINAL_TABLE_SIZE_ULEB
+                _ = try uleb(opcodes, &i);
+            },
+            else => return error.InvalidBindOpcode,
+        }
+        if (binds == 0) continue;
+        switch (stream) {
+            .normal => fixups.binds += binds,
+            .lazy => fixups.lazy_binds += binds,
+            // Weak definitions are coalesced by name, not bound to a dylib.
+            .weak => {
+                fixups.weak_binds += binds;
+                continue;
+            },
+        }
+        if (ordinal < 1 or ordinal > dylibs.len) continue;
+        const dylib = &dylibs[@intCast(ordinal - 1)];
+        dylib.binds += binds;
+        const gop = try dylib.imports.getOrPut(arena, symbol);
+        if (!gop.found_existing and weak) dylib.weak_imports += 1;
+    }
+}
+
+/// Also skips SLEB128 values, which have the same continuation bits.
+fn uleb(bytes: []const u8, i: *usize) !usize {
+    var result: usize = 0;
+    var shift: u32 = 0;
+    while (true) {
+        if (i.* >= bytes.len) return error.Truncated;
+        const byte = bytes[i.*];
+        i.* += 1;
+        if (shift < @bitSizeOf(usize)) result |= @as(usize, byte & 0x7f) << @intCast(shift);
+        shift += 7;
+        if (byte & 0x80 == 0) return result;
+    }
+}
+
+fn int(comptime T: type, comptime endian: std.builtin.Endian, bytes: []const u8, offset: u64) !T {
+    if (offset + @sizeOf(T) > bytes.len) return error.Truncated;
+    return std.mem.readInt(T, bytes[@intCast(offset)..][0..@sizeOf(T)], endian);
+}
+
+fn cstring(bytes: []const u8, offset: u64) ![]const u8 {
+    if (offset >= bytes.len) return error.Truncated;
+    const rest = bytes[@intCast(offset)..];
+    return rest[0 .. std.mem.indexOfScalar(u8, rest, 0) orelse return error.Truncated];
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
+
+fn testDylibs() [2]Dylib {
+    return .{
+        .{ .install_name = "/usr/lib/libfoo.dylib", .kind = .load },
+        .{ .install_name = "/usr/lib/libbar.dylib", .kind = .weak },
+    };
+}
+
+/// `LC_DYLD_CHAINED_FIXUPS` data for one segment at file offset 0 with one
+/// page whose chain starts at offset 0.
+fn testChainedFixups(arena: std.mem.Allocator, pointer_format: u16, imports_format: u32, imports: []const u8, symbols: []const u8) ![]const u8 {
+    var data = std.ArrayList(u8).init(arena);
+    const writer = data.writer();
+    const starts_offset = 32;
+    const imports_offset = starts_offset + 8 + 24;
+    try writer.writeInt(u32, 0, .little); // fixups_version
+    try writer.writeInt(u32, starts_offset, .little);
+    try writer.writeInt(u32, imports_offset, .little);
+    try writer.writeInt(u32, @intCast(imports_offset + imports.len), .little); // symbols_offset
+    const import_size: usize = switch (imports_format) {
+        1 => 4,
+        2 => 8,
+        else => 16,
+    };
+    try writer.writeInt(u32, @intCast(imports.len / import_size), .little); // imports_count
+    try writer.writeInt(u32, imports_format, .little);
+    try writer.writeInt(u32, 0, .little); // symbols_format
+    try writer.writeByteNTimes(0, starts_offset - data.items.len);
+    // dyld_chained_starts_in_image
+    try writer.writeInt(u32, 1, .little); // seg_count
+    try writer.writeInt(u32, 8, .little); // seg_info_offset[0]
+    // dyld_chained_starts_in_segment
+    try writer.writeInt(u32, 24, .little); // size
+    try writer.writeInt(u16, 0x4000, .little); // page_size
+    try writer.writeInt(u16, pointer_format, .little);
+    try writer.writeInt(u64, 0, .little); // segment_offset
+    try writer.writeInt(u32, 0, .little); // max_valid_pointer
+    try writer.writeInt(u16, 1, .little); // page_count
+    try writer.writeInt(u16, 0, .little); // page_start[0]
+    try writer.writeAll(imports);
+    try writer.writeAll(symbols);
+    return data.items;
+}
+
+fn testBytes(arena: std.mem.Allocator, pointers: []const u64) ![]const u8 {
+    const bytes = try arena.alloc(u8, pointers.len * 8);
+    for (pointers, 0..) |pointer, i| std.mem.writeInt(u64, bytes[i * 8 ..][0..8], pointer, .little);
+    return bytes;
+}
+
+test "chained fixups with DYLD_CHAINED_IMPORT and DYLD_CHAINED_PTR_64_OFFSET" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var imports: [8]u8 = undefined;
+    // lib_ordinal:8, weak_import:1, name_offset:23
+    std.mem.writeInt(u32, imports[0..4], 1 | 1 << 8 | 1 << 9, .little);
+    std.mem.writeInt(u32, imports[4..8], 2 | 6 << 9, .little);
+    const data = try testChainedFixups(arena, 6, 1, &imports, "\x00_foo\x00_bar\x00");
+    // A rebase, then binds to both imports; `next` counts 4-byte strides.
+    const bytes = try testBytes(arena, &.{
+        0x1000 | 2 << 51,
+        1 << 63 | 2 << 51 | 0,
+        1 << 63 | 1,
+    });
+
+    var dylibs = testDylibs();
+    var fixups: Fixups = .{};
+    try readChainedFixups(arena, bytes, data, &.{.{ .fileoff = 0, .filesize = bytes.len }}, &dylibs, &fixups);
+    try std.testing.expectEqual(1, fixups.rebases);
+    try std.testing.expectEqual(2, fixups.binds);
+    try std.testing.expectEqualStrings("_foo", dylibs[0].imports.keys()[0]);
+    try std.testing.expectEqual(1, dylibs[0].weak_imports);
+    try std.testing.expectEqual(1, dylibs[0].binds);
+    try std.testing.expectEqualStrings("_bar", dylibs[1].imports.keys()[0]);
+    try std.testing.expectEqual(0, dylibs[1].weak_imports);
+    try std.testing.expectEqual(1, dylibs[1].binds);
+}
+
+test "chained fixups with DYLD_CHAINED_IMPORT_ADDEND64 and DYLD_CHAINED_PTR_ARM64E_USERLAND24" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var imports: [32]u8 = undefined;
+    // lib_ordinal:16, weak_import:1, reserved:15, name_offset:32, then the
+    // addend; the second import is a flat namespace lookup (-2).
+    std.mem.writeInt(u64, imports[0..8], 2 | 1 << 32, .little);
+    std.mem.writeInt(u64, imports[8..16], 0, .little);
+    std.mem.writeInt(u64, imports[16..24], 0xfffe | 6 << 32, .little);
+    std.mem.writeInt(u64, imports[24..32], 0, .little);
+    const data = try testChainedFixups(arena, 12, 3, &imports, "\x00_foo\x00_bar\x00");
+    // Binds to both imports; `next` counts 8-byte strides.
+    const bytes = try testBytes(arena, &.{
+        1 << 62 | 1 << 51 | 0,
+        1 << 62 | 1,
+    });
+
+    var dylibs = testDylibs();
+    var fixups: Fixups = .{};
+    try readChainedFixups(arena, bytes, data, &.{.{ .fileoff = 0, .filesize = bytes.len }}, &dylibs, &fixups);
+    try std.testing.expectEqual(0, fixups.rebases);
+    try std.testing.expectEqual(2, fixups.binds);
+    try std.testing.expectEqual(0, dylibs[0].imports.count());
+    try std.testing.expectEqualStrings("_foo", dylibs[1].imports.keys()[0]);
+    try std.testing.expectEqual(1, dylibs[1].binds);
+}
+
+test "bind opcodes" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var dylibs = testDylibs();
+    var fixups: Fixups = .{};
+    try readBinds(arena, &[_]u8{
+        0x11, // SET_DYLIB_ORDINAL_IMM 1
+        0x41, '_', 'f', 'o', 'o', 0, // SET_SYMBOL_TRAILING_FLAGS_IMM weak
+        0x51, // SET_TYPE_IMM pointer
+        0x72, 0x80, 0x01, // SET_SEGMENT_AND_OFFSET_ULEB 2, 128
+        0x90, // DO_BIND
+        0xc0, 0x03, 0x08, // DO_BIND_ULEB_TIMES_SKIPPING_ULEB 3, 8
+        0x20, 0x02, // SET_DYLIB_ORDINAL_ULEB 2
+        0x40, '_', 'b', 'a', 'r', 0, // SET_SYMBOL_TRAILING_FLAGS_IMM
+        0x60, 0x7f, // SET_ADDEND_SLEB -1
+        0xa0, 0x08, // DO_BIND_ADD_ADDR_ULEB 8
+        0x3e, // SET_DYLIB_SPECIAL_IMM flat lookup
+        0x40, '_', 'b', 'a', 'z', 0,
+        0xb1, // DO_BIND_ADD_ADDR_IMM_SCALED 1
+        0x00, // DONE
+        0x90, // never read
+    }, .normal, &dylibs, &fixups);
+    try std.testing.expectEqual(6, fixups.binds);
+    try std.testing.expectEqual(4, dylibs[0].binds);
+    try std.testing.expectEqual(1, dylibs[0].imports.count());
+    try std.testing.expectEqual(1, dylibs[0].weak_imports);
+    try std.testing.expectEqual(1, dylibs[1].binds);
+    try std.testing.expectEqualStrings("_bar", dylibs[1].imports.keys()[0]);
+
+    // DONE separates the entries of the lazy stream.
+    try readBinds(arena, &[_]u8{
+        0x72, 0x00, 0x11, 0x40, '_', 'a', 0, 0x90, 0x00,
+        0x72, 0x08, 0x12, 0x40, '_', 'b', 0, 0x90, 0x00,
+    }, .lazy, &dylibs, &fixups);
+    try std.testing.expectEqual(2, fixups.lazy_binds);
+    try std.testing.expectEqual(2, dylibs[0].imports.count());
+    try std.testing.expectEqual(2, dylibs[1].imports.count());
+
+    // Weak definitions are coalesced, not bound to a dylib.
+    try readBinds(arena, &[_]u8{ 0x40, '_', 'w', 0, 0x90, 0x00 }, .weak, &dylibs, &fixups);
+    try std.testing.expectEqual(1, fixups.weak_binds);
+    try std.testing.expectEqual(6, fixups.binds);
+}
+
+test "rebase opcodes" {
+    try std.testing.expectEqual(8, try countRebases(&[_]u8{
+        0x11, // SET_TYPE_IMM pointer
+        0x22, 0x10, // SET_SEGMENT_AND_OFFSET_ULEB 2, 16
+        0x53, // DO_REBASE_IMM_TIMES 3
+        0x60, 0x02, // DO_REBASE_ULEB_TIMES 2
+        0x70, 0x08, // DO_REBASE_ADD_ADDR_ULEB 8
+        0x80, 0x02, 0x08, // DO_REBASE_ULEB_TIMES_SKIPPING_ULEB 2, 8
+        0x00, // DONE
+    }));
+    try std.testing.expectError(error.Truncated, countRebases(&[_]u8{ 0x60, 0x80 }));
+}
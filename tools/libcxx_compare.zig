@@ -0,0 +1,82 @@
+//! Compares building a C++ program with the libc++ Zig builds from source
+//! (`zig c++`, what `linkLibCpp` does) against compiling it with the libc++
+//! headers of the SDK and linking the `libc++.tbd` stub (what
+//! `linkSystemLibCpp` does). Each build starts from empty Zig caches, so the
+//! times are those of a cold cache, and the sizes are of the linked
+//! executables.
+//!
+//! Usage: libcxx_compare <output-dir> <zig-exe> <sdk-root> <triple> <source>
+
+const std = @import("std");
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 6) fatal("usage: {s} <output-dir> <zig-exe> <sdk-root> <triple> <source>", .{args[0]});
+    const out_path = args[1];
+    const zig = args[2];
+    const sdk = args[3];
+    const triple = args[4];
+    const source = args[5];
+    try std.fs.cwd().makePath(out_path);
+
+    // Compile flags, and the inputs linked after the source.
+    const Variant = struct { name: []const u8, driver: []const u8, flags: []const []const u8, inputs: []const []const u8 };
+    const variants = [_]Variant{
+        .{ .name = "linkLibCpp", .driver = "c++", .flags = &.{}, .inputs = &.{} },
+        .{
+            .name = "linkSystemLibCpp",
+            .driver = "cc",
+            .flags = &.{
+                "-x",
+                "c++",
+                "-nostdinc++",
+                "-isystem",
+                try std.fs.path.join(arena, &.{ sdk, "include", "c++", "v1" }),
+                "-isystem",
+                try std.fs.path.join(arena, &.{ sdk, "include" }),
+            },
+            .inputs = &.{ "-x", "none", try std.fs.path.join(arena, &.{ sdk, "lib", "libc++.tbd" }) },
+        },
+    };
+
+    const stdout = std.io.getStdOut().writer();
+    for (variants) |variant| {
+        const cache = try std.fs.path.join(arena, &.{ out_path, try std.fmt.allocPrint(arena, "{s}-cache", .{variant.name}) });
+        try std.fs.cwd().deleteTree(cache);
+        var env = try std.process.getEnvMap(arena);
+        try env.put("ZIG_GLOBAL_CACHE_DIR", cache);
+        try env.put("ZIG_LOCAL_CACHE_DIR", cache);
+
+        const bin = try std.fs.path.join(arena, &.{ out_path, variant.name });
+        var argv = std.ArrayList([]const u8).init(arena);
+        try argv.appendSlice(&.{ zig, variant.driver, "-target", triple, "-O2" });
+        try argv.appendSlice(variant.flags);
+        try argv.append(source);
+        try argv.appendSlice(variant.inputs);
+        try argv.appendSlice(&.{ "-o", bin });
+
+        var timer = try std.time.Timer.start();
+        const result = try std.process.Child.run(.{ .allocator = arena, .argv = argv.items, .env_map = &env });
+        const ns = timer.read();
+        switch (result.term) {
+            .Exited => |code| if (code != 0) {
+                std.io.getStdErr().writeAll(result.stderr) catch {};
+                fatal("{s} build failed", .{variant.name});
+            },
+            else => fatal("{s} build failed", .{variant.name}),
+        }
+        const size = (try std.fs.cwd().statFile(bin)).size;
+        try stdout.print("{s} {s:<16}: cold build {d:>8.1} s, binary {d:>10} bytes\n", .{
+            triple, variant.name, @as(f64, @floatFromInt(ns)) / std.time.ns_per_s, size,
+        });
+    }
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
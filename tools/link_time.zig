@@ -0,0 +1,73 @@
+//! Times linking the same object against the `.tbd` text stubs of the
+//! package and against the binary stub dylibs generated from them. The two
+//! links alternate, so both see the same machine load, and every run passes
+//! a different `-headerpad` so that no link is replayed from Zig's cache.
+//!
+//! Usage: link_time <output-dir> <zig-exe> <triple> <runs> <object> <sdk-root> <stub-root> <link-args>...
+
+const std = @import("std");
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 8) fatal("usage: {s} <output-dir> <zig-exe> <triple> <runs> <object> <sdk-root> <stub-root> <link-args>...", .{args[0]});
+    const out_path = args[1];
+    const zig = args[2];
+    const triple = args[3];
+    const runs = try std.fmt.parseInt(usize, args[4], 10);
+    const object = args[5];
+    const roots = [2][]const u8{ args[6], args[7] };
+    const names = [2][]const u8{ "text stubs", "binary stubs" };
+    const link_args = args[8..];
+    if (runs == 0) fatal("at least one run is needed", .{});
+    try std.fs.cwd().makePath(out_path);
+
+    var times: [2][]u64 = undefined;
+    for (&times) |*t| t.* = try arena.alloc(u64, runs);
+    for (0..runs) |run| {
+        for (roots, 0..) |root, i| {
+            var argv = std.ArrayList([]const u8).init(arena);
+            try argv.appendSlice(&.{ zig, "cc", "-target", triple, object });
+            try argv.appendSlice(&.{ "-o", try std.fs.path.join(arena, &.{ out_path, try std.fmt.allocPrint(arena, "link-{d}", .{i}) }) });
+            try argv.appendSlice(&.{ "-F", try std.fs.path.join(arena, &.{ root, "Frameworks" }) });
+            try argv.appendSlice(&.{ "-L", try std.fs.path.join(arena, &.{ root, "lib" }) });
+            try argv.append(try std.fmt.allocPrint(arena, "-Wl,-headerpad,0x{x}", .{0x1000 + 8 * run}));
+            try argv.appendSlice(link_args);
+
+            var timer = try std.time.Timer.start();
+            const result = try std.process.Child.run(.{ .allocator = arena, .argv = argv.items });
+            times[i][run] = timer.read();
+            switch (result.term) {
+                .Exited => |code| if (code == 0) continue,
+                else => {},
+            }
+            std.io.getStdErr().writeAll(result.stderr) catch {};
+            fatal("linking against the {s} failed", .{names[i]});
+        }
+    }
+
+    const stdout = std.io.getStdOut().writer();
+    var medians: [2]u64 = undefined;
+    for (&times, names, &medians) |t, name, *median| {
+        std.mem.sort(u64, t, {}, std.sort.asc(u64));
+        median.* = t[t.len / 2];
+        try stdout.print("{s} link against {s:<12}: median {d:>8.1} ms, fastest {d:>8.1} ms ({d} runs)\n", .{
+            triple, name, ms(median.*), ms(t[0]), runs,
+        });
+    }
+    try stdout.print("{s} binary stubs link {d:.2}x as fast\n", .{
+        triple, @as(f64, @floatFromInt(medians[0])) / @as(f64, @floatFromInt(@max(medians[1], 1))),
+    });
+}
+
+fn ms(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / std.time.ns_per_ms;
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,124 @@
+//! Merges thin Mach-O files into a universal binary laid out like
+//! `lipo -create`: a big-endian `fat_header` and one `fat_arch` per slice
+//! (see `include/mach-o/fat.h`), each slice aligned to the page size of its
+//! architecture. The written file is read back and its header checked
+//! against the slices before the tool succeeds.
+//!
+//! Usage: lipo <output> <slice>...
+
+const std = @import("std");
+const macho = std.macho;
+
+const cpu_type_arm64: u32 = 0x0100000c;
+const fat_arch_size = 5 * @sizeOf(u32);
+
+const Slice = struct {
+    path: []const u8,
+    data: []const u8,
+    cputype: u32,
+    cpusubtype: u32,
+    /// Power of two.
+    @"align": u5,
+    offset: u32 = 0,
+
+    fn lessThan(_: void, a: Slice, b: Slice) bool {
+        return a.@"align" < b.@"align";
+    }
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 3) fatal("usage: {s} <output> <slice>...", .{args[0]});
+    const output_path = args[1];
+
+    var slices = std.ArrayList(Slice).init(arena);
+    for (args[2..]) |path| {
+        const data = try std.fs.cwd().readFileAlloc(arena, path, std.math.maxInt(u32));
+        if (data.len < @sizeOf(macho.mach_header_64) or
+            std.mem.readInt(u32, data[0..4], .little) != macho.MH_MAGIC_64)
+            fatal("'{s}' is not a 64-bit Mach-O file", .{path});
+        const cputype = std.mem.readInt(u32, data[4..8], .little);
+        for (slices.items) |other| {
+            if (other.cputype == cputype) fatal("'{s}' and '{s}' have the same architecture", .{ other.path, path });
+        }
+        try slices.append(.{
+            .path = path,
+            .data = data,
+            .cputype = cputype,
+            // Copied whole, capability bits included (the pointer
+            // authentication ABI version of arm64e), as lipo does.
+            .cpusubtype = std.mem.readInt(u32, data[8..12], .little),
+            // 16K pages on Apple silicon, 4K on Intel.
+            .@"align" = if (cputype == cpu_type_arm64) 14 else 12,
+        });
+    }
+    // Like lipo, order by alignment to keep the padding small.
+    std.sort.insertion(Slice, slices.items, {}, Slice.lessThan);
+
+    var end: u64 = @sizeOf(macho.fat_header) + fat_arch_size * slices.items.len;
+    for (slices.items) |*slice| {
+        end = std.mem.alignForward(u64, end, @as(u64, 1) << slice.@"align");
+        if (end + slice.data.len > std.math.maxInt(u32)) fatal("universal binary exceeds 4 GiB", .{});
+        slice.offset = @intCast(end);
+        end += slice.data.len;
+    }
+
+    var out = std.ArrayList(u8).init(arena);
+    const writer = out.writer();
+    try writer.writeInt(u32, macho.FAT_MAGIC, .big);
+    try writer.writeInt(u32, @intCast(slices.items.len), .big);
+    for (slices.items) |slice| {
+        try writer.writeInt(u32, slice.cputype, .big);
+        try writer.writeInt(u32, slice.cpusubtype, .big);
+        try writer.writeInt(u32, slice.offset, .big);
+        try writer.writeInt(u32, @intCast(slice.data.len), .big);
+        try writer.writeInt(u32, slice.@"align", .big);
+    }
+    for (slices.items) |slice| {
+        try out.appendNTimes(0, slice.offset - out.items.len);
+        try out.appendSlice(slice.data);
+    }
+
+    const file = try std.fs.cwd().createFile(output_path, .{ .mode = 0o755 });
+    defer file.close();
+    try file.writeAll(out.items);
+
+    try verify(arena, output_path, slices.items);
+}
+
+/// Reads the universal binary back and checks every `fat_arch` against the
+/// slice it was written from.
+fn verify(arena: std.mem.Allocator, path: []const u8, slices: []const Slice) !void {
+    const data = try std.fs.cwd().readFileAlloc(arena, path, std.math.maxInt(u32));
+    var stream = std.io.fixedBufferStream(data);
+    const reader = stream.reader();
+    if (try reader.readInt(u32, .big) != macho.FAT_MAGIC) fatal("{s}: bad fat magic", .{path});
+    if (try reader.readInt(u32, .big) != slices.len) fatal("{s}: bad nfat_arch", .{path});
+
+    var previous_end: u64 = @sizeOf(macho.fat_header) + fat_arch_size * slices.len;
+    for (slices) |slice| {
+        const cputype = try reader.readInt(u32, .big);
+        const cpusubtype = try reader.readInt(u32, .big);
+        const offset = try reader.readInt(u32, .big);
+        const size = try reader.readInt(u32, .big);
+        const @"align" = try reader.readInt(u32, .big);
+        if (cputype != slice.cputype or cpusubtype != slice.cpusubtype)
+            fatal("{s}: fat_arch for '{s}' has the wrong cpu type", .{ path, slice.path });
+        if (@"align" != slice.@"align" or offset % (@as(u64, 1) << slice.@"align") != 0)
+            fatal("{s}: '{s}' is not aligned to 2^{d}", .{ path, slice.path, slice.@"align" });
+        if (offset < previous_end or @as(u64, offset) + size > data.len)
+            fatal("{s}: '{s}' overlaps another slice or the end of the file", .{ path, slice.path });
+        if (!std.mem.eql(u8, data[offset..][0..size], slice.data))
+            fatal("{s}: contents of '{s}' differ", .{ path, slice.path });
+        previous_end = @as(u64, offset) + size;
+    }
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,883 @@
+//! Generates Zig bindings for the Objective-C classes and protocols declared
+//! in framework headers. Each method casts `objc_msgSend` to its exact
+//! prototype and passes a selector reference from `__objc_selrefs`, and
+//! classes are referenced through `__objc_classrefs`, the way clang emits
+//! them, so dyld binds both at load time and no lookup by name happens at
+//! run time. A class is only emitted if the `.tbd` of its framework (or of
+//! libobjc) exports it. Methods using types without a direct Zig equivalent
+//! (blocks, function pointers, varargs, unknown structs) are skipped. A
+//! method whose wrapper name is already taken, by the helpers every class
+//! has or by another method of the same name (`+description` and
+//! `-description`), gets trailing underscores.
+//!
+//! Usage: objc_bindings <output.zig> <depfile> <sdk-root> <framework>...
+
+const std = @import("std");
+const tbd = @import("tbd.zig");
+const headers = @import("headers.zig");
+
+const stripComments = headers.stripComments;
+const startsWithKeyword = headers.startsWithKeyword;
+const isIdentifierChar = headers.isIdentifierChar;
+const identifier = headers.identifier;
+const trailingIdentifier = headers.trailingIdentifier;
+const matching = headers.matching;
+const isMacroName = headers.isMacroName;
+const contains = headers.contains;
+const lessThan = headers.lessThan;
+
+const prelude = @embedFile("objc_prelude.zig");
+
+const Method = struct {
+    class_method: bool,
+    selector: []const u8,
+    return_type: []const u8,
+    param_types: []const []const u8,
+    /// The declaration on a single line, used as doc comment.
+    declaration: []const u8,
+};
+
+const Interface = struct {
+    super: ?[]const u8 = null,
+    /// Names of the generic parameters (`NSArray<ObjectType>`), which stand
+    /// for any object.
+    generics: []const []const u8 = &.{},
+    methods: std.ArrayList(Method),
+};
+
+/// A type reduced to its name, pointer depth and protocol qualifier:
+/// `nullable id<MTLDevice> *` is `id`, 1, `MTLDevice`.
+const Spelling = struct {
+    base: []const u8,
+    stars: usize,
+    protocol: ?[]const u8,
+};
+
+const Type = struct {
+    zig: []const u8,
+    /// Size of a struct returned by value, zero otherwise.
+    struct_size: usize = 0,
+};
+
+/// Structs defined in the prelude and their sizes on 64-bit targets.
+const structs = std.StaticStringMap(usize).initComptime(.{
+    .{ "CGPoint", 16 },
+    .{ "CGSize", 16 },
+    .{ "CGRect", 32 },
+    .{ "CGAffineTransform", 48 },
+    .{ "NSPoint", 16 },
+    .{ "NSSize", 16 },
+    .{ "NSRect", 32 },
+    .{ "NSRange", 16 },
+    .{ "NSEdgeInsets", 32 },
+    .{ "MTLClearColor", 32 },
+    .{ "MTLOrigin", 24 },
+    .{ "MTLSize", 24 },
+    .{ "MTLRegion", 48 },
+    .{ "MTLViewport", 48 },
+    .{ "MTLScissorRect", 32 },
+});
+
+const primitives = std.StaticStringMap([]const u8).initComptime(.{
+    .{ "void", "void" },
+    .{ "IBAction", "void" },
+    .{ "BOOL", "runtime.BOOL" },
+    .{ "bool", "bool" },
+    .{ "_Bool", "bool" },
+    .{ "char", "u8" },
+    .{ "signed char", "i8" },
+    .{ "unsigned char", "u8" },
+    .{ "short", "c_short" },
+    .{ "unsigned short", "c_ushort" },
+    .{ "int", "c_int" },
+    .{ "unsigned", "c_uint" },
+    .{ "unsigned int", "c_uint" },
+    .{ "long", "c_long" },
+    .{ "unsigned long", "c_ulong" },
+    .{ "long long", "c_longlong" },
+    .{ "unsigned long long", "c_ulonglong" },
+    .{ "float", "f32" },
+    .{ "double", "f64" },
+    .{ "NSInteger", "isize" },
+    .{ "NSUInteger", "usize" },
+    .{ "CGFloat", "f64" },
+    .{ "CFIndex", "isize" },
+    .{ "CGGlyph", "u16" },
+    .{ "unichar", "u16" },
+    .{ "UniChar", "u16" },
+    .{ "size_t", "usize" },
+    .{ "intptr_t", "isize" },
+    .{ "uintptr_t", "usize" },
+    .{ "int8_t", "i8" },
+    .{ "int16_t", "i16" },
+    .{ "int32_t", "i32" },
+    .{ "int64_t", "i64" },
+    .{ "uint8_t", "u8" },
+    .{ "uint16_t", "u16" },
+    .{ "uint32_t", "u32" },
+    .{ "uint64_t", "u64" },
+    .{ "SEL", "?runtime.SEL" },
+    .{ "Class", "?runtime.Class" },
+});
+
+/// Words that do not change how a type is passed.
+const qualifiers = std.StaticStringMap(void).initComptime(.{
+    .{"const"},
+    .{"volatile"},
+    .{"struct"},
+    .{"enum"},
+    .{"nullable"},
+    .{"nonnull"},
+    .{"null_unspecified"},
+    .{"null_resettable"},
+    .{"_Nullable"},
+    .{"_Nonnull"},
+    .{"_Null_unspecified"},
+    .{"__nullable"},
+    .{"__nonnull"},
+    .{"__kindof"},
+    .{"__strong"},
+    .{"__weak"},
+    .{"__unsafe_unretained"},
+    .{"__autoreleasing"},
+    .{"__covariant"},
+    .{"__contravariant"},
+    .{"oneway"},
+    .{"in"},
+    .{"out"},
+    .{"inout"},
+    .{"bycopy"},
+    .{"byref"},
+    .{"IBOutlet"},
+    .{"IBInspectable"},
+});
+
+/// Names the generated code uses itself; methods with these names get a
+/// trailing underscore.
+const reserved = std.StaticStringMap(void).initComptime(.{ .{"self"}, .{"send"}, .{"T"}, .{"runtime"}, .{"builtin"}, .{"std"} });
+
+const Generator = struct {
+    arena: std.mem.Allocator,
+    classes: std.StringArrayHashMap(Interface),
+    protocols: std.StringArrayHashMap(Interface),
+    /// Names from `@class` forward declarations.
+    forward: std.StringHashMap(void),
+    typedefs: std.StringHashMap([]const u8),
+    /// Classes exported by the stubs.
+    exported: std.StringHashMap(void),
+    /// Every file read, for the depfile.
+    inputs: std.ArrayList([]const u8),
+
+    fn init(arena: std.mem.Allocator) Generator {
+        return .{
+            .arena = arena,
+            .classes = std.StringArrayHashMap(Interface).init(arena),
+            .protocols = std.StringArrayHashMap(Interface).init(arena),
+            .forward = std.StringHashMap(void).init(arena),
+            .typedefs = std.StringHashMap([]const u8).init(arena),
+            .exported = std.StringHashMap(void).init(arena),
+            .inputs = std.ArrayList([]const u8).init(arena),
+        };
+    }
+
+    fn addExports(gen: *Generator, path: []const u8) !void {
+        const src = std.fs.cwd().readFileAlloc(gen.arena, path, 64 << 20) catch |err|
+            fatal("unable to read '{s}': {s}", .{ path, @errorName(err) });
+        try gen.inputs.append(path);
+        for (try tbd.parse(gen.arena, src)) |doc| {
+            for ([_][]const tbd.Section{ doc.exports, doc.reexports }) |sections| {
+                for (sections) |section| {
+                    for (section.objc_classes) |name| try gen.exported.put(name, {});
+                    for (section.symbols) |symbol| {
+                        if (std.mem.startsWith(u8, symbol, "_OBJC_CLASS_$_"))
+                            try gen.exported.put(symbol["_OBJC_CLASS_$_".len..], {});
+                    }
+                }
+            }
+        }
+    }
+
+    fn addHeaders(gen: *Generator, headers_path: []const u8) !void {
+        var dir = std.fs.cwd().openDir(headers_path, .{ .iterate = true }) catch |err|
+            fatal("unable to open '{s}': {s}", .{ headers_path, @errorName(err) });
+        defer dir.close();
+
+        var paths = std.ArrayList([]const u8).init(gen.arena);
+        var walker = try dir.walk(gen.arena);
+        defer walker.deinit();
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file or !std.mem.endsWith(u8, entry.path, ".h")) continue;
+            try paths.append(try gen.arena.dupe(u8, entry.path));
+        }
+        std.mem.sort([]const u8, paths.items, {}, lessThan);
+
+        for (paths.items) |path| {
+            const full_path = try std.fs.path.join(gen.arena, &.{ headers_path, path });
+            try gen.inputs.append(full_path);
+            const text = try stripComments(gen.arena, try dir.readFileAlloc(gen.arena, path, 16 << 20));
+            try gen.parseTypedefs(text);
+            try gen.parseDeclarations(text);
+        }
+    }
+
+    /// `typedef NS_ENUM(NSUInteger, Name)`, `NS_OPTIONS`, `NS_CLOSED_ENUM`,
+    /// `NS_ERROR_ENUM` and plain `typedef <type> <name>`; struct and function
+    /// pointer typedefs are ignored.
+    fn parseTypedefs(gen: *Generator, text: []const u8) !void {
+        var i: usize = 0;
+        while (std.mem.indexOfPos(u8, text, i, "typedef")) |start| {
+            i = start + "typedef".len;
+            if (start > 0 and isIdentifierChar(text[start - 1])) continue;
+            if (i < text.len and isIdentifierChar(text[i])) continue;
+            const end = std.mem.indexOfScalarPos(u8, text, i, ';') orelse return;
+            const stmt = std.mem.trim(u8, text[i..end], whitespace);
+            i = end;
+
+            for ([_][]const u8{ "NS_ENUM(", "NS_OPTIONS(", "NS_CLOSED_ENUM(", "NS_ERROR_ENUM(" }) |macro| {
+                if (!std.mem.startsWith(u8, stmt, macro)) continue;
+                const close = std.mem.indexOfScalar(u8, stmt, ')') orelse break;
+                var args = std.mem.splitScalar(u8, stmt[macro.len..close], ',');
+                const first = std.mem.trim(u8, args.next() orelse break, whitespace);
+                const second = std.mem.trim(u8, args.next() orelse break, whitespace);
+                if (std.mem.eql(u8, macro, "NS_ERROR_ENUM(")) {
+                    try gen.typedefs.put(second, "NSInteger");
+                } else {
+                    try gen.typedefs.put(second, first);
+                }
+                break;
+            } else {
+                if (std.mem.indexOfAny(u8, stmt, "({") != null) continue;
+                const decl = stripTrailingMacros(stmt);
+                const name_start = trailingIdentifier(decl) orelse continue;
+                const target = std.mem.trim(u8, decl[0..name_start], whitespace);
+                if (target.len == 0) continue;
+                const gop = try gen.typedefs.getOrPut(decl[name_start..]);
+                if (!gop.found_existing) gop.value_ptr.* = target;
+            }
+        }
+    }
+
+    fn parseDeclarations(gen: *Generator, text: []const u8) !void {
+        var i: usize = 0;
+        while (std.mem.indexOfScalarPos(u8, text, i, '@')) |at| {
+            const rest = text[at..];
+            if (startsWithKeyword(rest, "@class")) {
+                const end = std.mem.indexOfScalarPos(u8, text, at, ';') orelse return;
+                var names = std.mem.tokenizeAny(u8, text[at + "@class".len .. end], ", \t\r\n");
+                while (names.next()) |name| {
+                    if (identifier(name)) |id| try gen.forward.put(id, {});
+                }
+                i = end;
+            } else if (startsWithKeyword(rest, "@interface")) {
+                const header_end = headerEnd(text, at, "\n{");
+                const body_end = std.mem.indexOfPos(u8, text, header_end, "@end") orelse text.len;
+                try gen.parseInterface(text[at + "@interface".len .. header_end], text[header_end..body_end]);
+                i = body_end;
+            } else if (startsWithKeyword(rest, "@protocol")) {
+                const header_end = headerEnd(text, at, "\n;");
+                const header = std.mem.trim(u8, text[at + "@protocol".len .. header_end], whitespace);
+                const name = identifier(header) orelse {
+                    i = at + 1;
+                    continue;
+                };
+                const after = std.mem.trimLeft(u8, header[name.len..], whitespace);
+                // Forward declarations: `@protocol A;` and `@protocol A, B;`.
+                if ((header_end < text.len and text[header_end] == ';') or (after.len > 0 and after[0] != '<')) {
+                    i = std.mem.indexOfScalarPos(u8, text, at, ';') orelse return;
+                    continue;
+                }
+                const body_end = std.mem.indexOfPos(u8, text, header_end, "@end") orelse text.len;
+                const gop = try gen.protocols.getOrPut(name);
+                if (!gop.found_existing) gop.value_ptr.* = .{ .methods = std.ArrayList(Method).init(gen.arena) };
+                try gen.parseBody(gop.value_ptr, text[header_end..body_end]);
+                i = body_end;
+            } else {
+                i = at + 1;
+            }
+        }
+    }
+
+    /// `Name<Generics> : Super <Protocols>` or `Name<Generics> (Category)`.
+    fn parseInterface(gen: *Generator, header: []const u8, body: []const u8) !void {
+        var rest = std.mem.trim(u8, header, whitespace);
+        const name = identifier(rest) orelse return;
+        rest = std.mem.trimLeft(u8, rest[name.len..], whitespace);
+
+        var generics = std.ArrayList([]const u8).init(gen.arena);
+        if (rest.len > 0 and rest[0] == '<') {
+            const close = matching(rest, 0, '<', '>') orelse return;
+            var params = std.mem.splitScalar(u8, rest[1..close], ',');
+            while (params.next()) |param| {
+                const trimmed = std.mem.trim(u8, param, whitespace);
+                const start = trailingIdentifier(trimmed) orelse continue;
+                try generics.append(trimmed[start..]);
+            }
+            rest = std.mem.trimLeft(u8, rest[close + 1 ..], whitespace);
+        }
+
+        var super: ?[]const u8 = null;
+        if (rest.len > 0 and rest[0] == ':') super = identifier(std.mem.trimLeft(u8, rest[1..], whitespace));
+
+        const gop = try gen.classes.getOrPut(name);
+        if (!gop.found_existing) gop.value_ptr.* = .{ .methods = std.ArrayList(Method).init(gen.arena) };
+        const iface = gop.value_ptr;
+        if (iface.super == null) iface.super = super;
+        if (iface.generics.len == 0) iface.generics = generics.items;
+        try gen.parseBody(iface, body);
+    }
+
+    fn parseBody(gen: *Generator, iface: *Interface, body: []const u8) !void {
+        var text = std.mem.trimLeft(u8, body, whitespace);
+        // Instance variables.
+        if (text.len > 0 and text[0] == '{') {
+            const close = matching(text, 0, '{', '}') orelse return;
+            text = text[close + 1 ..];
+        }
+
+        var statements = std.mem.splitScalar(u8, text, ';');
+        while (statements.next()) |raw| {
+            var stmt = std.mem.trim(u8, raw, whitespace);
+            strip: while (true) {
+                for ([_][]const u8{ "@optional", "@required", "@public", "@private", "@protected", "@package" }) |keyword| {
+                    if (std.mem.startsWith(u8, stmt, keyword)) {
+                        stmt = std.mem.trimLeft(u8, stmt[keyword.len..], whitespace);
+                        continue :strip;
+                    }
+                }
+                break;
+            }
+            stmt = stripLeadingMacros(stmt);
+            if (stmt.len == 0 or isUnavailable(stmt)) continue;
+
+            if (stmt[0] == '-' or stmt[0] == '+') {
+                if (try gen.parseMethod(stmt)) |method| try iface.methods.append(method);
+            } else if (startsWithKeyword(stmt, "@property")) {
+                try gen.parseProperty(iface, stmt);
+            }
+        }
+    }
+
+    /// `- (ret)part:(type)name part:(type)name`, with any trailing
+    /// attributes ignored. Returns null for varargs.
+    fn parseMethod(gen: *Generator, stmt: []const u8) !?Method {
+        var rest = std.mem.trimLeft(u8, stmt[1..], whitespace);
+        var return_type: []const u8 = "id";
+        if (rest.len > 0 and rest[0] == '(') {
+            const close = matching(rest, 0, '(', ')') orelse return null;
+            return_type = rest[1..close];
+            rest = std.mem.trimLeft(u8, rest[close + 1 ..], whitespace);
+        }
+
+        var selector = std.ArrayList(u8).init(gen.arena);
+        var params = std.ArrayList([]const u8).init(gen.arena);
+        var part = identifier(rest) orelse "";
+        rest = std.mem.trimLeft(u8, rest[part.len..], whitespace);
+        if (rest.len == 0 or rest[0] != ':') {
+            if (part.len == 0) return null;
+            try selector.appendSlice(part);
+        } else while (true) {
+            try selector.appendSlice(part);
+            try selector.append(':');
+            rest = std.mem.trimLeft(u8, rest[1..], whitespace);
+            var param_type: []const u8 = "id";
+            if (rest.len > 0 and rest[0] == '(') {
+                const close = matching(rest, 0, '(', ')') orelse return null;
+                param_type = rest[1..close];
+                rest = std.mem.trimLeft(u8, rest[close + 1 ..], whitespace);
+            }
+            try params.append(param_type);
+            const param_name = identifier(rest) orelse return null;
+            rest = std.mem.trimLeft(u8, rest[param_name.len..], whitespace);
+            if (rest.len > 0 and rest[0] == ',') return null;
+
+            part = identifier(rest) orelse "";
+            const after = std.mem.trimLeft(u8, rest[part.len..], whitespace);
+            if (after.len == 0 or after[0] != ':') break;
+            rest = after;
+        }
+
+        return .{
+            .class_method = stmt[0] == '+',
+            .selector = selector.items,
+            .return_type = return_type,
+            .param_types = params.items,
+            .declaration = try collapse(gen.arena, stmt),
+        };
+    }
+
+    /// `@property (attributes) type name`: a getter, and a setter unless
+    /// the property is readonly.
+    fn parseProperty(gen: *Generator, iface: *Interface, stmt: []const u8) !void {
+        var rest = std.mem.trimLeft(u8, stmt["@property".len..], whitespace);
+        var readonly = false;
+        var class_property = false;
+        var getter: ?[]const u8 = null;
+        var setter: ?[]const u8 = null;
+        if (rest.len > 0 and rest[0] == '(') {
+            const close = matching(rest, 0, '(', ')') orelse return;
+            var attributes = std.mem.splitScalar(u8, rest[1..close], ',');
+            while (attributes.next()) |attribute| {
+                const trimmed = std.mem.trim(u8, attribute, whitespace);
+                if (std.mem.eql(u8, trimmed, "readonly")) {
+                    readonly = true;
+                } else if (std.mem.eql(u8, trimmed, "class")) {
+                    class_property = true;
+                } else if (std.mem.startsWith(u8, trimmed, "getter=")) {
+                    getter = std.mem.trim(u8, trimmed["getter=".len..], whitespace);
+                } else if (std.mem.startsWith(u8, trimmed, "setter=")) {
+                    setter = std.mem.trim(u8, trimmed["setter=".len..], whitespace);
+                }
+            }
+            rest = std.mem.trimLeft(u8, rest[close + 1 ..], whitespace);
+        }
+
+        const decl = stripTrailingMacros(rest);
+        if (std.mem.indexOfAny(u8, decl, "(^,") != null) return;
+        const name_start = trailingIdentifier(decl) orelse return;
+        const name = decl[name_start..];
+        const property_type = std.mem.trim(u8, decl[0..name_start], whitespace);
+        if (property_type.len == 0) return;
+
+        const declaration = try collapse(gen.arena, stmt);
+        try iface.methods.append(.{
+            .class_method = class_property,
+            .selector = getter orelse name,
+            .return_type = property_type,
+            .param_types = &.{},
+            .declaration = declaration,
+        });
+        if (readonly) return;
+        try iface.methods.append(.{
+            .class_method = class_property,
+            .selector = setter orelse try std.fmt.allocPrint(gen.arena, "set{c}{s}:", .{
+                std.ascii.toUpper(name[0]), name[1..],
+            }),
+            .return_type = "void",
+            .param_types = try gen.arena.dupe([]const u8, &.{property_type}),
+            .declaration = declaration,
+        });
+    }
+
+    fn isEmittedClass(gen: *Generator, name: []const u8) bool {
+        return gen.classes.contains(name) and gen.exported.contains(name);
+    }
+
+    fn isEmittedProtocol(gen: *Generator, name: []const u8) bool {
+        return gen.protocols.contains(name) and !gen.classes.contains(name);
+    }
+
+    fn mapType(gen: *Generator, raw: []const u8, self_name: []const u8, generics: []const []const u8) !?Type {
+        const spelling = try normalize(gen.arena, raw) orelse return null;
+        return gen.resolve(spelling, self_name, generics, 0);
+    }
+
+    fn resolve(
+        gen: *Generator,
+        spelling: Spelling,
+        self_name: []const u8,
+        generics: []const []const u8,
+        depth: usize,
+    ) !?Type {
+        const base = spelling.base;
+        const stars = spelling.stars;
+
+        if (std.mem.eql(u8, base, "instancetype")) return try objectPointer(gen.arena, self_name, stars + 1);
+        if (std.mem.eql(u8, base, "id") or contains(generics, base)) {
+            const protocol = spelling.protocol orelse "";
+            const target = if (gen.isEmittedProtocol(protocol)) protocol else "runtime.Id";
+            return try objectPointer(gen.arena, target, stars + 1);
+        }
+        if (gen.classes.contains(base) or gen.protocols.contains(base) or gen.forward.contains(base)) {
+            const target = if (gen.isEmittedClass(base) or gen.isEmittedProtocol(base)) base else "runtime.Id";
+            return try objectPointer(gen.arena, target, stars);
+        }
+
+        if (primitives.get(base)) |zig| {
+            if (stars == 0) return .{ .zig = zig };
+            if (stars > 1) return null;
+            if (std.mem.eql(u8, base, "char")) return .{ .zig = "?[*:0]const u8" };
+            if (std.mem.eql(u8, zig, "void")) return .{ .zig = "?*anyopaque" };
+            return .{ .zig = try std.fmt.allocPrint(gen.arena, "?*{s}", .{zig}) };
+        }
+        if (structs.get(base)) |size| {
+            if (stars == 0) return .{ .zig = base, .struct_size = size };
+            if (stars > 1) return null;
+            return .{ .zig = try std.fmt.allocPrint(gen.arena, "?*{s}", .{base}) };
+        }
+        if (gen.typedefs.get(base)) |target| {
+            if (depth == 8) return null;
+            var aliased = try normalize(gen.arena, target) orelse return null;
+            aliased.stars += stars;
+            if (aliased.protocol == null) aliased.protocol = spelling.protocol;
+            return gen.resolve(aliased, self_name, generics, depth + 1);
+        }
+        // Core Foundation style references.
+        if (std.mem.endsWith(u8, base, "Ref")) {
+            if (stars == 0) return .{ .zig = "?*anyopaque" };
+            if (stars == 1) return .{ .zig = "?*?*anyopaque" };
+        }
+        return null;
+    }
+
+    fn emit(gen: *Generator, writer: anytype, frameworks: []const []const u8) !void {
+        try writer.print("//! Generated by tools/objc_bindings.zig from the {s} headers. Do not edit.\n\n", .{
+            try std.mem.join(gen.arena, ", ", frameworks),
+        });
+        try writer.writeAll(prelude);
+
+        // Method names must not shadow top-level declarations.
+        var top_level = std.StringHashMap(void).init(gen.arena);
+        for (structs.keys()) |name| try top_level.put(name, {});
+        for (gen.classes.keys()) |name| {
+            if (gen.isEmittedClass(name)) try top_level.put(name, {});
+        }
+        for (gen.protocols.keys()) |name| {
+            if (gen.isEmittedProtocol(name)) try top_level.put(name, {});
+        }
+
+        for (gen.classes.keys(), gen.classes.values()) |name, iface| {
+            if (gen.isEmittedClass(name)) try gen.emitInterface(writer, &top_level, name, iface, true);
+        }
+        for (gen.protocols.keys(), gen.protocols.values()) |name, iface| {
+            if (gen.isEmittedProtocol(name)) try gen.emitInterface(writer, &top_level, name, iface, false);
+        }
+    }
+
+    fn emitInterface(
+        gen: *Generator,
+        writer: anytype,
+        top_level: *const std.StringHashMap(void),
+        name: []const u8,
+        iface: Interface,
+        is_class: bool,
+    ) !void {
+        const id = std.zig.fmtId(name);
+        try writer.print("\npub const {} = opaque {{\n", .{id});
+        if (is_class) {
+            if (iface.super) |super| {
+                if (gen.isEmittedClass(super)) try writer.print("    pub const Super = {};\n\n", .{std.zig.fmtId(super)});
+            }
+            try writer.print(
+                \\    pub fn objcClass() runtime.Class {{
+                \\        return runtime.classRef("{s}");
+                \\    }}
+                \\
+                \\
+            , .{name});
+        }
+        try writer.print(
+            \\    pub fn as(self: *{}, comptime T: type) *T {{
+            \\        return @ptrCast(self);
+            \\    }}
+            \\
+        , .{id});
+
+        var used = std.StringHashMap(?Method).init(gen.arena);
+        for ([_][]const u8{ "Super", "objcClass", "as" }) |helper| try used.put(helper, null);
+        for (iface.methods.items) |method| {
+            if (method.class_method and !is_class) continue;
+            try gen.emitMethod(writer, top_level, &used, name, iface.generics, method);
+        }
+        try writer.writeAll("};\n");
+    }
+
+    fn emitMethod(
+        gen: *Generator,
+        writer: anytype,
+        top_level: *const std.StringHashMap(void),
+        /// Wrapper names already emitted, and the method of each; null for
+        /// the helpers.
+        used: *std.StringHashMap(?Method),
+        self_name: []const u8,
+        generics: []const []const u8,
+        method: Method,
+    ) !void {
+        const return_type = try gen.mapType(method.return_type, self_name, generics) orelse return;
+        const param_types = try gen.arena.alloc([]const u8, method.param_types.len);
+        for (param_types, method.param_types) |*zig, raw| {
+            const param_type = try gen.mapType(raw, self_name, generics) orelse return;
+            zig.* = param_type.zig;
+        }
+
+        // `setObject:forKey:` becomes `setObject_forKey`.
+        var fn_name = std.ArrayList(u8).init(gen.arena);
+        var parts = std.mem.tokenizeScalar(u8, method.selector, ':');
+        while (parts.next()) |part| {
+            if (fn_name.items.len > 0) try fn_name.append('_');
+            try fn_name.appendSlice(part);
+        }
+        if (reserved.has(fn_name.items) or top_level.contains(fn_name.items)) try fn_name.append('_');
+        while (used.get(fn_name.items)) |taken| {
+            // Redeclared in a category or by a property.
+            if (taken) |other| {
+                if (other.class_method == method.class_method and std.mem.eql(u8, other.selector, method.selector)) return;
+            }
+            try fn_name.append('_');
+        }
+        try used.put(fn_name.items, method);
+
+        const self_id = std.zig.fmtId(self_name);
+        const send = if (return_type.struct_size > 16) "msg_send_stret" else "msg_send";
+        try writer.print("\n    /// {s}\n    pub fn {}(", .{ method.declaration, std.zig.fmtId(fn_name.items) });
+        if (!method.class_method) try writer.print("self: *{}", .{self_id});
+        for (param_types, 0..) |zig, index| {
+            if (index > 0 or !method.class_method) try writer.writeAll(", ");
+            try writer.print("arg{d}: {s}", .{ index, zig });
+        }
+        try writer.print(") {s} {{\n        const send: *const fn (", .{return_type.zig});
+        if (method.class_method) {
+            try writer.writeAll("runtime.Class");
+        } else {
+            try writer.print("*{}", .{self_id});
+        }
+        try writer.writeAll(", runtime.SEL");
+        for (param_types) |zig| try writer.print(", {s}", .{zig});
+        try writer.print(") callconv(.c) {s} = @ptrCast(runtime.{s});\n        return send(", .{ return_type.zig, send });
+        try writer.writeAll(if (method.class_method) "objcClass()" else "self");
+        try writer.print(", runtime.sel(\"{s}\")", .{method.selector});
+        for (0..param_types.len) |index| try writer.print(", arg{d}", .{index});
+        try writer.writeAll(");\n    }\n");
+    }
+};
+
+const whitespace = " \t\r\n";
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 5) fatal("usage: {s} <output.zig> <depfile> <sdk-root> <framework>...", .{args[0]});
+    const output_path = args[1];
+    const dep_path = args[2];
+    const sdk_root = args[3];
+    const frameworks = args[4..];
+
+    var gen = Generator.init(arena);
+    // NSObject and friends live in libobjc.
+    try gen.addExports(try std.fs.path.join(arena, &.{ sdk_root, "lib", "libobjc.tbd" }));
+    for (frameworks) |name| {
+        const framework_path = try std.fs.path.join(arena, &.{
+            sdk_root, "Frameworks", try std.mem.concat(arena, u8, &.{ name, ".framework" }),
+        });
+        try gen.addExports(try std.fs.path.join(arena, &.{
+            framework_path, try std.mem.concat(arena, u8, &.{ name, ".tbd" }),
+        }));
+        try gen.addHeaders(try std.fs.path.join(arena, &.{ framework_path, "Headers" }));
+    }
+
+    var output = std.ArrayList(u8).init(arena);
+    try gen.emit(output.writer(), frameworks);
+    try std.fs.cwd().writeFile(.{ .sub_path = output_path, .data = output.items });
+    try headers.writeDepFile(arena, dep_path, output_path, gen.inputs.items);
+}
+
+/// The end of an `@interface` or `@protocol` line: the first of `stops`
+/// outside angle brackets, which may span lines.
+fn headerEnd(text: []const u8, start: usize, stops: []const u8) usize {
+    var depth: usize = 0;
+    for (text[start..], start..) |c, i| {
+        if (c == '<') depth += 1;
+        if (c == '>' and depth > 0) depth -= 1;
+        if (depth == 0 and std.mem.indexOfScalar(u8, stops, c) != null) return i;
+    }
+    return text.len;
+}
+
+fn normalize(arena: std.mem.Allocator, raw: []const u8) !?Spelling {
+    if (std.mem.indexOfAny(u8, raw, "(^[") != null) return null;
+    var words = std.ArrayList([]const u8).init(arena);
+    var stars: usize = 0;
+    var protocol: ?[]const u8 = null;
+    var i: usize = 0;
+    while (i < raw.len) {
+        const c = raw[i];
+        if (c == '*') {
+            stars += 1;
+            i += 1;
+        } else if (c == '<') {
+            const close = matching(raw, i, '<', '>') orelse return null;
+            const inner = std.mem.trim(u8, raw[i + 1 .. close], whitespace);
+            if (protocol == null and identifier(inner) != null and identifier(inner).?.len == inner.len) protocol = inner;
+            i = close + 1;
+        } else if (isIdentifierChar(c)) {
+            const word = identifier(raw[i..]).?;
+            if (!qualifiers.has(word) and !isMacroName(word)) try words.append(word);
+            i += word.len;
+        } else {
+            i += 1;
+        }
+    }
+    if (words.items.len == 0) return null;
+    return .{
+        .base = try std.mem.join(arena, " ", words.items),
+        .stars = stars,
+        .protocol = protocol,
+    };
+}
+
+/// `name` is a generated declaration or `runtime.Id`.
+fn objectPointer(arena: std.mem.Allocator, name: []const u8, stars: usize) !?Type {
+    const id = if (std.mem.startsWith(u8, name, "runtime."))
+        name
+    else
+        try std.fmt.allocPrint(arena, "{}", .{std.zig.fmtId(name)});
+    return switch (stars) {
+        1 => .{ .zig = try std.fmt.allocPrint(arena, "?*{s}", .{id}) },
+        2 => .{ .zig = try std.fmt.allocPrint(arena, "?*?*{s}", .{id}) },
+        else => null,
+    };
+}
+
+/// Whether the declaration is marked unavailable on macOS.
+fn isUnavailable(stmt: []const u8) bool {
+    for ([_][]const u8{ "NS_UNAVAILABLE", "UNAVAILABLE_ATTRIBUTE", "__attribute__((unavailable" }) |marker| {
+        if (std.mem.indexOf(u8, stmt, marker) != null) return true;
+    }
+    var i: usize = 0;
+    while (std.mem.indexOfPos(u8, stmt, i, "API_UNAVAILABLE(")) |start| {
+        const open = start + "API_UNAVAILABLE".len;
+        const close = matching(stmt, open, '(', ')') orelse return false;
+        if (std.mem.indexOf(u8, stmt[open..close], "macos") != null) return true;
+        i = close;
+    }
+    return false;
+}
+
+/// Skips availability and Swift annotations in front of a declaration.
+fn stripLeadingMacros(stmt: []const u8) []const u8 {
+    var rest = stmt;
+    while (identifier(rest)) |word| {
+        if (!isMacroName(word)) break;
+        rest = std.mem.trimLeft(u8, rest[word.len..], whitespace);
+        if (rest.len > 0 and rest[0] == '(') {
+            const close = matching(rest, 0, '(', ')') orelse return rest;
+            rest = std.mem.trimLeft(u8, rest[close + 1 ..], whitespace);
+        }
+    }
+    return rest;
+}
+
+/// Drops `API_AVAILABLE(...)`, `NS_SWIFT_NAME(...)`, `NS_TYPED_ENUM` and
+/// the like from the end of a declaration.
+fn stripTrailingMacros(decl: []const u8) []const u8 {
+    var rest = std.mem.trimRight(u8, decl, whitespace);
+    while (rest.len > 0) {
+        var end = rest.len;
+        if (rest[end - 1] == ')') {
+            var depth: usize = 0;
+            var open = end;
+            while (open > 0) {
+                open -= 1;
+                if (rest[open] == ')') depth += 1;
+                if (rest[open] == '(') {
+                    depth -= 1;
+                    if (depth == 0) break;
+                }
+            }
+            if (depth != 0) break;
+            end = std.mem.trimRight(u8, rest[0..open], whitespace).len;
+        }
+        const start = trailingIdentifier(rest[0..end]) orelse break;
+        if (!isMacroName(rest[start..end])) break;
+        rest = std.mem.trimRight(u8, rest[0..start], whitespace);
+    }
+    return rest;
+}
+
+fn collapse(arena: std.mem.Allocator, text: []const u8) ![]const u8 {
+    var out = std.ArrayList(u8).init(arena);
+    var words = std.mem.tokenizeAny(u8, text, whitespace);
+    while (words.next()) |word| {
+        if (out.items.len > 0) try out.append(' ');
+        try out.appendSlice(word);
+    }
+    try out.append(';');
+    return out.items;
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
+
+test "parse and emit" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    var gen = Generator.init(arena);
+    try gen.exported.put("NSObject", {});
+    try gen.exported.put("Widget", {});
+    const text = try stripComments(arena,
+        \\typedef NS_ENUM(NSInteger, WidgetKind) {
+        \\    WidgetKindPlain,
+        \\};
+        \\@class NSString;
+        \\@protocol NSCopying;
+        \\
+        \\@interface NSObject
+        \\- (NSString *)description;
+        \\+ (NSString *)description;
+        \\@end
+        \\
+        \\/* Widgets. */
+        \\@interface Widget<ObjectType> : NSObject
+        \\@property (readonly) WidgetKind kind;
+        \\@property (nonatomic) CGRect frame API_AVAILABLE(macos(10.15));
+        \\- (ObjectType)as;
+        \\- (void)setObject:(ObjectType)object forKey:(id<NSCopying>)key;
+        \\- (void)log:(NSString *)format, ...;
+        \\- (void)run:(void (^)(void))block;
+        \\- (void)old NS_UNAVAILABLE;
+        \\@end
+        \\
+        \\@interface Widget (Extras)
+        \\- (WidgetKind)kind;
+        \\@end
+    );
+    try gen.parseTypedefs(text);
+    try gen.parseDeclarations(text);
+
+    try std.testing.expectEqual(2, gen.classes.count());
+    const widget = gen.classes.get("Widget").?;
+    try std.testing.expectEqualStrings("NSObject", widget.super.?);
+    try std.testing.expectEqual(1, widget.generics.len);
+    try std.testing.expectEqualStrings("ObjectType", widget.generics[0]);
+    const selectors = [_][]const u8{ "kind", "frame", "setFrame:", "as", "setObject:forKey:", "run:", "kind" };
+    try std.testing.expectEqual(selectors.len, widget.methods.items.len);
+    for (selectors, widget.methods.items) |selector, method| try std.testing.expectEqualStrings(selector, method.selector);
+    try std.testing.expectEqualStrings("CGRect", widget.methods.items[2].param_types[0]);
+
+    var output = std.ArrayList(u8).init(arena);
+    try gen.emit(output.writer(), &.{"Widget"});
+    const source = try output.toOwnedSliceSentinel(0);
+    const tree = try std.zig.Ast.parse(arena, source, .zig);
+    try std.testing.expectEqual(0, tree.errors.len);
+
+    for ([_][]const u8{
+        "pub const Super = NSObject;",
+        "return runtime.classRef(\"Widget\");",
+        // The instance method keeps the name, the class method is escaped.
+        "pub fn description(self: *NSObject) ?*runtime.Id {",
+        "pub fn description_() ?*runtime.Id {",
+        "return send(objcClass(), runtime.sel(\"description\"));",
+        // `as` is taken by the cast helper.
+        "pub fn as_(self: *Widget) ?*runtime.Id {",
+        "return send(self, runtime.sel(\"as\"));",
+        "pub fn kind(self: *Widget) isize {",
+        "pub fn frame(self: *Widget) CGRect {",
+        "= @ptrCast(runtime.msg_send_stret);",
+        "pub fn setObject_forKey(self: *Widget, arg0: ?*runtime.Id, arg1: ?*runtime.Id) void {",
+    }) |expected| {
+        if (std.mem.indexOf(u8, source, expected) == null) {
+            std.debug.print("missing: {s}\n", .{expected});
+            return error.TestExpectedEqual;
+        }
+    }
+    // Redeclared by the category, varargs, blocks and unavailable methods.
+    for ([_][]const u8{ "kind_", "fn log", "fn run", "fn old" }) |unexpected| {
+        try std.testing.expect(std.mem.indexOf(u8, source, unexpected) == null);
+    }
+}
@@ -0,0 +1,22 @@
+//! Analyzes every wrapper of the generated Objective-C bindings, which lazy
+//! analysis would otherwise skip, so that `zig build objc-bindings` compiles
+//! and links all of them against the stubs for each macOS target.
+
+const std = @import("std");
+const objc = @import("objc");
+
+pub fn main() void {
+    comptime refAllDecls(objc);
+}
+
+/// Like `std.testing.refAllDeclsRecursive`, which only works in tests.
+fn refAllDecls(comptime T: type) void {
+    @setEvalBranchQuota(100_000_000);
+    inline for (comptime std.meta.declarations(T)) |decl| {
+        if (@TypeOf(@field(T, decl.name)) == type) switch (@typeInfo(@field(T, decl.name))) {
+            .@"struct", .@"opaque" => refAllDecls(@field(T, decl.name)),
+            else => {},
+        };
+        _ = &@field(T, decl.name);
+    }
+}
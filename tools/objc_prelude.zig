@@ -0,0 +1,134 @@
+const builtin = @import("builtin");
+const std = @import("std");
+
+pub const runtime = struct {
+    pub const SEL = *opaque {};
+    pub const Class = *opaque {};
+    /// Any Objective-C object.
+    pub const Id = opaque {};
+    /// `signed char` on x86_64, `bool` on arm64.
+    pub const BOOL = if (builtin.cpu.arch == .x86_64) i8 else bool;
+
+    extern fn objc_msgSend() void;
+    extern fn objc_msgSend_stret() void;
+
+    /// Cast to the exact prototype of the method before calling.
+    pub const msg_send = &objc_msgSend;
+    /// For methods returning structs in memory. On x86_64 the hidden return
+    /// pointer is passed first, which is exactly how `objc_msgSend_stret`
+    /// expects it; arm64 has no separate entry point.
+    pub const msg_send_stret = if (builtin.cpu.arch == .x86_64) &objc_msgSend_stret else &objc_msgSend;
+
+    /// Marks the image as containing Objective-C metadata so the runtime
+    /// uniques the selector references below at load time. The linker merges
+    /// the `__objc_imageinfo` sections of all objects, including the ones
+    /// clang emits, so it is not exported, which could clash with another
+    /// copy of this module; `sel` references it so it is emitted with
+    /// internal linkage whenever a selector is used.
+    var image_info: [2]u32 linksection("__DATA,__objc_imageinfo,regular,no_dead_strip") = .{ 0, 64 };
+
+    /// A selector reference in `__objc_selrefs`, fixed up when the image is
+    /// loaded, like the ones clang emits for `@selector`. No lookup by name
+    /// happens at run time.
+    pub fn sel(comptime name: [:0]const u8) SEL {
+        const S = struct {
+            const method_name linksection("__TEXT,__objc_methname,cstring_literals") = name[0..name.len :0].*;
+            var ref: [*:0]const u8 linksection("__DATA,__objc_selrefs,literal_pointers,no_dead_strip") = &method_name;
+        };
+        std.mem.doNotOptimizeAway(&image_info);
+        // The runtime rewrites the reference, so it must be reloaded.
+        const ref: *volatile [*:0]const u8 = &S.ref;
+        return @ptrCast(@constCast(ref.*));
+    }
+
+    /// A class reference in `__objc_classrefs`, bound by dyld to the class
+    /// exported by the framework.
+    pub fn classRef(comptime name: []const u8) Class {
+        const S = struct {
+            var ref: *anyopaque linksection("__DATA,__objc_classrefs,regular,no_dead_strip") =
+                @extern(*anyopaque, .{ .name = "OBJC_CLASS_$_" ++ name });
+        };
+        const ref: *volatile *anyopaque = &S.ref;
+        return @ptrCast(ref.*);
+    }
+};
+
+pub const CGPoint = extern struct {
+    x: f64,
+    y: f64,
+};
+
+pub const CGSize = extern struct {
+    width: f64,
+    height: f64,
+};
+
+pub const CGRect = extern struct {
+    origin: CGPoint,
+    size: CGSize,
+};
+
+pub const CGAffineTransform = extern struct {
+    a: f64,
+    b: f64,
+    c: f64,
+    d: f64,
+    tx: f64,
+    ty: f64,
+};
+
+pub const NSPoint = CGPoint;
+pub const NSSize = CGSize;
+pub const NSRect = CGRect;
+
+pub const NSRange = extern struct {
+    location: usize,
+    length: usize,
+};
+
+pub const NSEdgeInsets = extern struct {
+    top: f64,
+    left: f64,
+    bottom: f64,
+    right: f64,
+};
+
+pub const MTLClearColor = extern struct {
+    red: f64,
+    green: f64,
+    blue: f64,
+    alpha: f64,
+};
+
+pub const MTLOrigin = extern struct {
+    x: usize,
+    y: usize,
+    z: usize,
+};
+
+pub const MTLSize = extern struct {
+    width: usize,
+    height: usize,
+    depth: usize,
+};
+
+pub const MTLRegion = extern struct {
+    origin: MTLOrigin,
+    size: MTLSize,
+};
+
+pub const MTLViewport = extern struct {
+    originX: f64,
+    originY: f64,
+    width: f64,
+    height: f64,
+    znear: f64,
+    zfar: f64,
+};
+
+pub const MTLScissorRect = extern struct {
+    x: usize,
+    y: usize,
+    width: usize,
+    height: usize,
+};
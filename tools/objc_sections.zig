@@ -0,0 +1,210 @@
+//! Checks the Objective-C metadata the bindings emit in a relocatable 64-bit
+//! Mach-O object (see `include/mach-o/loader.h` and `reloc.h`), the way
+//! clang emits it: `__objc_selrefs` must be a `S_LITERAL_POINTERS` section
+//! whose entries all point into the `S_CSTRING_LITERALS` section
+//! `__objc_methname`, every entry of `__objc_classrefs` must be relocated
+//! against an undefined `_OBJC_CLASS_$_` symbol, and `__objc_imageinfo` must
+//! be present with the flags the runtime expects. The given selector and
+//! class must be among the references.
+//!
+//! Usage: objc_sections <object> <selector> <class>
+
+const std = @import("std");
+
+const MH_MAGIC_64 = 0xfeedfacf;
+const MH_OBJECT = 0x1;
+const LC_SEGMENT_64 = 0x19;
+const LC_SYMTAB = 0x2;
+const SECTION_TYPE = 0xff;
+const S_CSTRING_LITERALS = 0x2;
+const S_LITERAL_POINTERS = 0x5;
+const S_ATTR_NO_DEAD_STRIP = 0x10000000;
+const N_TYPE = 0x0e;
+const N_UNDF = 0x0;
+
+const Section = struct {
+    segname: []const u8,
+    sectname: []const u8,
+    addr: u64,
+    size: u64,
+    offset: u32,
+    reloff: u32,
+    nreloc: u32,
+    flags: u32,
+};
+
+const Symbol = struct {
+    name: []const u8,
+    n_type: u8,
+    n_value: u64,
+};
+
+const Object = struct {
+    bytes: []const u8,
+    sections: []const Section,
+    symbols: []const Symbol,
+
+    fn section(object: Object, segname: []const u8, sectname: []const u8) ?Section {
+        for (object.sections) |sect| {
+            if (std.mem.eql(u8, sect.segname, segname) and std.mem.eql(u8, sect.sectname, sectname)) return sect;
+        }
+        return null;
+    }
+
+    fn contents(object: Object, sect: Section) ![]const u8 {
+        if (@as(u64, sect.offset) + sect.size > object.bytes.len) return error.Truncated;
+        return object.bytes[sect.offset..][0..@intCast(sect.size)];
+    }
+
+    /// The address each 8-byte pointer of the section refers to, and the
+    /// symbol it is relocated against if it is an external relocation.
+    fn pointers(object: Object, arena: std.mem.Allocator, sect: Section) ![]const Pointer {
+        const data = try object.contents(sect);
+        const result = try arena.alloc(Pointer, @intCast(sect.size / 8));
+        @memset(result, .{ .addr = 0, .symbol = null, .relocated = false });
+        for (0..sect.nreloc) |i| {
+            const reloc = sect.reloff + 8 * i;
+            const r_address = try int(u32, object.bytes, reloc);
+            const info = try int(u32, object.bytes, reloc + 4);
+            const r_symbolnum: u24 = @truncate(info);
+            const r_length: u2 = @truncate(info >> 25);
+            const r_extern = info & (1 << 27) != 0;
+            if (r_address % 8 != 0 or r_address / 8 >= result.len or r_length != 3) return error.BadRelocation;
+            // The addend of an unsigned relocation is stored in place.
+            const addend = try int(u64, data, r_address);
+            const pointer = &result[r_address / 8];
+            pointer.relocated = true;
+            if (r_extern) {
+                if (r_symbolnum >= object.symbols.len) return error.BadRelocation;
+                const symbol = object.symbols[r_symbolnum];
+                pointer.symbol = symbol;
+                pointer.addr = symbol.n_value +% addend;
+            } else {
+                pointer.addr = addend;
+            }
+        }
+        return result;
+    }
+};
+
+const Pointer = struct {
+    addr: u64,
+    symbol: ?Symbol,
+    relocated: bool,
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 4) fatal("usage: {s} <object> <selector> <class>", .{args[0]});
+    const path = args[1];
+    const object = try parse(arena, try std.fs.cwd().readFileAlloc(arena, path, 1 << 30));
+
+    const methname = object.section("__TEXT", "__objc_methname") orelse fatal("{s}: no __objc_methname section", .{path});
+    if (methname.flags & SECTION_TYPE != S_CSTRING_LITERALS) fatal("{s}: __objc_methname is not a cstring section", .{path});
+    const methname_data = try object.contents(methname);
+
+    const selrefs = object.section("__DATA", "__objc_selrefs") orelse fatal("{s}: no __objc_selrefs section", .{path});
+    if (selrefs.flags & SECTION_TYPE != S_LITERAL_POINTERS) fatal("{s}: __objc_selrefs is not a literal pointer section", .{path});
+    if (selrefs.flags & S_ATTR_NO_DEAD_STRIP == 0) fatal("{s}: __objc_selrefs may be dead stripped", .{path});
+    var found_selector = false;
+    for (try object.pointers(arena, selrefs)) |pointer| {
+        if (!pointer.relocated) fatal("{s}: a selector reference has no relocation", .{path});
+        if (pointer.addr < methname.addr or pointer.addr >= methname.addr + methname.size) fatal("{s}: a selector reference points outside __objc_methname", .{path});
+        const name = std.mem.sliceTo(methname_data[@intCast(pointer.addr - methname.addr)..], 0);
+        if (std.mem.eql(u8, name, args[2])) found_selector = true;
+    }
+    if (!found_selector) fatal("{s}: no reference to selector '{s}'", .{ path, args[2] });
+
+    const classrefs = object.section("__DATA", "__objc_classrefs") orelse fatal("{s}: no __objc_classrefs section", .{path});
+    if (classrefs.flags & S_ATTR_NO_DEAD_STRIP == 0) fatal("{s}: __objc_classrefs may be dead stripped", .{path});
+    const class_symbol = try std.mem.concat(arena, u8, &.{ "_OBJC_CLASS_$_", args[3] });
+    var found_class = false;
+    for (try object.pointers(arena, classrefs)) |pointer| {
+        const symbol = pointer.symbol orelse fatal("{s}: a class reference is not bound to a symbol", .{path});
+        if (!std.mem.startsWith(u8, symbol.name, "_OBJC_CLASS_$_")) fatal("{s}: class reference to '{s}'", .{ path, symbol.name });
+        if (symbol.n_type & N_TYPE != N_UNDF) fatal("{s}: class reference to '{s}', which is defined locally", .{ path, symbol.name });
+        if (std.mem.eql(u8, symbol.name, class_symbol)) found_class = true;
+    }
+    if (!found_class) fatal("{s}: no reference to class '{s}'", .{ path, args[3] });
+
+    const imageinfo = object.section("__DATA", "__objc_imageinfo") orelse fatal("{s}: no __objc_imageinfo section", .{path});
+    const imageinfo_data = try object.contents(imageinfo);
+    // Version 0, and the flag clang sets for categories with class
+    // properties.
+    if (imageinfo_data.len != 8 or try int(u32, imageinfo_data, 0) != 0 or try int(u32, imageinfo_data, 4) != 64) {
+        fatal("{s}: __objc_imageinfo is not {{ 0, 64 }}", .{path});
+    }
+}
+
+fn parse(arena: std.mem.Allocator, bytes: []const u8) !Object {
+    if (try int(u32, bytes, 0) != MH_MAGIC_64) return error.NotMachO64;
+    if (try int(u32, bytes, 12) != MH_OBJECT) return error.NotObject;
+
+    var sections = std.ArrayList(Section).init(arena);
+    var symbols = std.ArrayList(Symbol).init(arena);
+    const ncmds = try int(u32, bytes, 16);
+    var offset: usize = 32;
+    for (0..ncmds) |_| {
+        const cmd = try int(u32, bytes, offset);
+        const cmdsize = try int(u32, bytes, offset + 4);
+        switch (cmd) {
+            LC_SEGMENT_64 => {
+                const nsects = try int(u32, bytes, offset + 64);
+                for (0..nsects) |i| {
+                    const sect = offset + 72 + 80 * i;
+                    if (sect + 80 > bytes.len) return error.Truncated;
+                    try sections.append(.{
+                        .sectname = std.mem.sliceTo(bytes[sect..][0..16], 0),
+                        .segname = std.mem.sliceTo(bytes[sect + 16 ..][0..16], 0),
+                        .addr = try int(u64, bytes, sect + 32),
+                        .size = try int(u64, bytes, sect + 40),
+                        .offset = try int(u32, bytes, sect + 48),
+                        .reloff = try int(u32, bytes, sect + 56),
+                        .nreloc = try int(u32, bytes, sect + 60),
+                        .flags = try int(u32, bytes, sect + 64),
+                    });
+                }
+            },
+            LC_SYMTAB => {
+                const symoff = try int(u32, bytes, offset + 8);
+                const nsyms = try int(u32, bytes, offset + 12);
+                const stroff = try int(u32, bytes, offset + 16);
+                const strsize = try int(u32, bytes, offset + 20);
+                if (@as(usize, stroff) + strsize > bytes.len) return error.Truncated;
+                const strings = bytes[stroff..][0..strsize];
+                for (0..nsyms) |i| {
+                    const nlist = symoff + 16 * i;
+                    const strx = try int(u32, bytes, nlist);
+                    if (strx >= strings.len) return error.Truncated;
+                    try symbols.append(.{
+                        .name = std.mem.sliceTo(strings[strx..], 0),
+                        .n_type = try byte(bytes, nlist + 4),
+                        .n_value = try int(u64, bytes, nlist + 8),
+                    });
+                }
+            },
+            else => {},
+        }
+        offset += cmdsize;
+    }
+    return .{ .bytes = bytes, .sections = sections.items, .symbols = symbols.items };
+}
+
+fn int(comptime T: type, bytes: []const u8, offset: usize) !T {
+    if (offset + @sizeOf(T) > bytes.len) return error.Truncated;
+    return std.mem.readInt(T, bytes[offset..][0..@sizeOf(T)], .little);
+}
+
+fn byte(bytes: []const u8, offset: usize) !u8 {
+    if (offset >= bytes.len) return error.Truncated;
+    return bytes[offset];
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
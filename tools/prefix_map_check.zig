@@ -0,0 +1,139 @@
+//! Checks that `addPaths` makes objects built against the SDK identical
+//! across checkouts: a consumer project depends on two checkouts of this
+//! package at different paths, which share the SDK directories through
+//! symlinks, and compiles the same source using inline functions of the SDK
+//! headers with debug info against each. The source is added after
+//! `addPaths`, which must remap it all the same. The objects must be
+//! byte-identical, and objects built with the same include paths but
+//! without `addPaths` must differ, or the check proves nothing.
+//!
+//! Usage: prefix_map_check <work-dir> <zig-exe> <package-root>
+
+const std = @import("std");
+
+const probe_c =
+    \\#include <CoreFoundation/CoreFoundation.h>
+    \\#include <assert.h>
+    \\
+    \\int probe(void) {
+    \\    CFRange range = CFRangeMake(0, 1);
+    \\    assert(range.length == 1);
+    \\    return (int)range.location;
+    \\}
+    \\
+;
+
+const consumer_build_zig =
+    \\const std = @import("std");
+    \\const macos_sdk = @import("macos_sdk");
+    \\
+    \\pub fn build(b: *std.Build) void {
+    \\    const sdk = b.dependency("macos_sdk", .{});
+    \\    const target = b.resolveTargetQuery(.{ .cpu_arch = .aarch64, .os_tag = .macos });
+    \\
+    \\    const mapped = b.addObject(.{ .name = "probe", .target = target, .optimize = .Debug });
+    \\    macos_sdk.addPaths(mapped);
+    \\    // After addPaths on purpose.
+    \\    mapped.addCSourceFile(.{ .file = b.path("probe.c") });
+    \\    b.getInstallStep().dependOn(&b.addInstallFile(mapped.getEmittedBin(), "probe.o").step);
+    \\
+    \\    const unmapped = b.addObject(.{ .name = "probe", .target = target, .optimize = .Debug });
+    \\    unmapped.addSystemFrameworkPath(sdk.path("Frameworks"));
+    \\    unmapped.addSystemIncludePath(sdk.path("include"));
+    \\    unmapped.addCSourceFile(.{ .file = b.path("probe.c") });
+    \\    b.getInstallStep().dependOn(&b.addInstallFile(unmapped.getEmittedBin(), "probe-unmapped.o").step);
+    \\}
+    \\
+;
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 4) fatal("usage: {s} <work-dir> <zig-exe> <package-root>", .{args[0]});
+    try std.fs.cwd().makePath(args[1]);
+    const work_path = try std.fs.cwd().realpathAlloc(arena, args[1]);
+    const zig_exe = args[2];
+    const package_path = try std.fs.cwd().realpathAlloc(arena, args[3]);
+
+    var work = try std.fs.cwd().openDir(work_path, .{});
+    defer work.close();
+    var package = try std.fs.cwd().openDir(package_path, .{});
+    defer package.close();
+
+    const checkouts = [_][]const u8{ "checkout-a", "checkout-b" };
+    for (checkouts) |checkout| {
+        try work.deleteTree(checkout);
+        var dir = try work.makeOpenPath(checkout, .{});
+        defer dir.close();
+        for ([_][]const u8{ "build.zig", "build.zig.zon" }) |name| try package.copyFile(name, dir, name, .{});
+        try copyDir(package, dir, "tools");
+        for ([_][]const u8{ "Frameworks", "include", "lib" }) |top| {
+            try dir.symLink(try std.fs.path.join(arena, &.{ package_path, top }), top, .{ .is_directory = true });
+        }
+    }
+
+    // One consumer, so only the checkout differs between the builds.
+    try work.deleteTree("consumer");
+    var consumer = try work.makeOpenPath("consumer", .{});
+    defer consumer.close();
+    try consumer.writeFile(.{ .sub_path = "build.zig", .data = consumer_build_zig });
+    try consumer.writeFile(.{ .sub_path = "probe.c", .data = probe_c });
+    const consumer_path = try std.fs.path.join(arena, &.{ work_path, "consumer" });
+
+    var objects: [checkouts.len][2][]const u8 = undefined;
+    for (checkouts, &objects) |checkout, *object| {
+        // The upper half of a package fingerprint is the CRC-32 of its name.
+        const fingerprint = @as(u64, std.hash.Crc32.hash("prefix_map_consumer")) << 32 | 1;
+        try consumer.writeFile(.{ .sub_path = "build.zig.zon", .data = try std.fmt.allocPrint(arena,
+            \\.{{
+            \\    .name = .prefix_map_consumer,
+            \\    .fingerprint = 0x{x},
+            \\    .version = "0.0.0",
+            \\    .dependencies = .{{ .macos_sdk = .{{ .path = "../{s}" }} }},
+            \\    .paths = .{{""}},
+            \\}}
+            \\
+        , .{ fingerprint, checkout }) });
+        const prefix = try std.fs.path.join(arena, &.{ work_path, "out", checkout });
+        try run(arena, consumer_path, &.{ zig_exe, "build", "--prefix", prefix });
+        for (object, [_][]const u8{ "probe.o", "probe-unmapped.o" }) |*bytes, name| {
+            bytes.* = try std.fs.cwd().readFileAlloc(arena, try std.fs.path.join(arena, &.{ prefix, name }), 64 << 20);
+        }
+    }
+
+    if (std.mem.eql(u8, objects[0][1], objects[1][1])) {
+        fatal("objects built in two checkouts without addPaths are identical; the check proves nothing", .{});
+    }
+    if (!std.mem.eql(u8, objects[0][0], objects[1][0])) {
+        fatal("objects built in two checkouts with addPaths differ: {s}/out/checkout-a/probe.o and {s}/out/checkout-b/probe.o", .{ work_path, work_path });
+    }
+}
+
+fn copyDir(from: std.fs.Dir, to: std.fs.Dir, sub_path: []const u8) !void {
+    var source = try from.openDir(sub_path, .{ .iterate = true });
+    defer source.close();
+    var dest = try to.makeOpenPath(sub_path, .{});
+    defer dest.close();
+    var it = source.iterate();
+    while (try it.next()) |entry| {
+        if (entry.kind == .file) try source.copyFile(entry.name, dest, entry.name, .{});
+    }
+}
+
+fn run(arena: std.mem.Allocator, cwd: []const u8, argv: []const []const u8) !void {
+    const result = try std.process.Child.run(.{ .allocator = arena, .argv = argv, .cwd = cwd, .max_output_bytes = 1 << 20 });
+    switch (result.term) {
+        .Exited => |code| if (code == 0) return,
+        else => {},
+    }
+    std.io.getStdErr().writeAll(result.stderr) catch {};
+    fatal("{s} failed", .{try std.mem.join(arena, " ", argv)});
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,331 @@
+//! Measures the package per framework and per `include/` subtree: file
+//! count, bytes, bytes duplicated elsewhere in the package, symlinks, `.tbd`
+//! stub bytes and the time taken to hash the subtree the way the package
+//! manager does. The report is written as JSON and the sizes are compared
+//! against a committed baseline.
+//!
+//! Usage: sdk_stats <sdk-root> [--output <file>] [--baseline <file> [--update] [--tolerance <percent>]]
+
+const std = @import("std");
+const Sha256 = std.crypto.hash.sha2.Sha256;
+
+const Stats = struct {
+    name: []const u8,
+    files: u64 = 0,
+    bytes: u64 = 0,
+    duplicate_bytes: u64 = 0,
+    symlinks: u64 = 0,
+    stub_bytes: u64 = 0,
+    hash_ns: u64 = 0,
+
+    fn accumulate(total: *Stats, stats: Stats) void {
+        total.files += stats.files;
+        total.bytes += stats.bytes;
+        total.duplicate_bytes += stats.duplicate_bytes;
+        total.symlinks += stats.symlinks;
+        total.stub_bytes += stats.stub_bytes;
+        total.hash_ns += stats.hash_ns;
+    }
+};
+
+/// Sizes only: timings are machine dependent and never part of the baseline.
+const BaselineEntry = struct {
+    name: []const u8,
+    files: u64,
+    bytes: u64,
+    duplicate_bytes: u64,
+    symlinks: u64,
+    stub_bytes: u64,
+};
+
+const Report = struct {
+    total: Stats,
+    subtrees: []const Stats,
+};
+
+const Baseline = struct {
+    total: BaselineEntry,
+    subtrees: []const BaselineEntry,
+};
+
+const Item = struct {
+    path: []const u8,
+    kind: std.fs.File.Kind,
+
+    fn lessThan(_: void, a: Item, b: Item) bool {
+        return std.mem.lessThan(u8, a.path, b.path);
+    }
+};
+
+const top_dirs = [_][]const u8{ "Frameworks", "include", "lib" };
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 2) fatal("usage: {s} <sdk-root> [--output <file>] [--baseline <file> [--update] [--tolerance <percent>]]", .{args[0]});
+    var output_path: ?[]const u8 = null;
+    var baseline_path: ?[]const u8 = null;
+    var update = false;
+    var tolerance: f64 = 1.0;
+    var i: usize = 2;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--output") and i + 1 < args.len) {
+            i += 1;
+            output_path = args[i];
+        } else if (std.mem.eql(u8, args[i], "--baseline") and i + 1 < args.len) {
+            i += 1;
+            baseline_path = args[i];
+        } else if (std.mem.eql(u8, args[i], "--tolerance") and i + 1 < args.len) {
+            i += 1;
+            tolerance = try std.fmt.parseFloat(f64, args[i]);
+        } else if (std.mem.eql(u8, args[i], "--update")) {
+            update = true;
+        } else fatal("unknown argument '{s}'", .{args[i]});
+    }
+
+    const report = try measure(arena, args[1]);
+
+    const stdout = std.io.getStdOut().writer();
+    try printTable(stdout, report);
+
+    if (output_path) |path| {
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        try std.json.stringify(report, .{ .whitespace = .indent_2 }, file.writer());
+    }
+
+    const path = baseline_path orelse return;
+    if (update) {
+        const subtrees = try arena.alloc(BaselineEntry, report.subtrees.len);
+        for (subtrees, report.subtrees) |*entry, stats| entry.* = baselineEntry(stats);
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        try std.json.stringify(Baseline{
+            .total = baselineEntry(report.total),
+            .subtrees = subtrees,
+        }, .{ .whitespace = .indent_2 }, file.writer());
+        try file.writeAll("\n");
+        try stdout.print("\nwrote baseline to {s}\n", .{path});
+        return;
+    }
+
+    const bytes = std.fs.cwd().readFileAlloc(arena, path, 16 << 20) catch |err|
+        fatal("unable to read baseline '{s}': {s}", .{ path, @errorName(err) });
+    const baseline = try std.json.parseFromSliceLeaky(Baseline, arena, bytes, .{ .ignore_unknown_fields = true });
+    if (try compare(stdout, arena, baseline, report, tolerance)) {
+        fatal("package grew by more than {d}% against {s}; rerun with --update if intended", .{ tolerance, path });
+    }
+}
+
+fn measure(arena: std.mem.Allocator, root_path: []const u8) !Report {
+    var root = try std.fs.cwd().openDir(root_path, .{});
+    defer root.close();
+
+    // Collect every entry first so duplicates are attributed to the same
+    // subtree regardless of directory iteration order.
+    var items = std.ArrayList(Item).init(arena);
+    for (top_dirs) |top| {
+        var dir = root.openDir(top, .{ .iterate = true }) catch |err| switch (err) {
+            error.FileNotFound => continue,
+            else => return err,
+        };
+        defer dir.close();
+        var walker = try dir.walk(arena);
+        defer walker.deinit();
+        while (try walker.next()) |entry| switch (entry.kind) {
+            .file, .sym_link => try items.append(.{
+                .path = try std.fs.path.join(arena, &.{ top, entry.path }),
+                .kind = entry.kind,
+            }),
+            else => {},
+        };
+    }
+    std.mem.sort(Item, items.items, {}, Item.lessThan);
+
+    var subtrees = std.StringArrayHashMap(Stats).init(arena);
+    var seen = std.AutoHashMap([Sha256.digest_length]u8, void).init(arena);
+    var link_buf: [std.fs.max_path_bytes]u8 = undefined;
+    for (items.items) |item| {
+        const name = subtreeName(item.path);
+        const gop = try subtrees.getOrPut(name);
+        if (!gop.found_existing) gop.value_ptr.* = .{ .name = name };
+        const stats = gop.value_ptr;
+
+        // Mirrors the package manager: the path, then the link target or
+        // the executable bit and contents.
+        var digest: [Sha256.digest_length]u8 = undefined;
+        if (item.kind == .sym_link) {
+            const target = try root.readLink(item.path, &link_buf);
+            var timer = try std.time.Timer.start();
+            var hasher = Sha256.init(.{});
+            hasher.update(item.path);
+            hasher.update(target);
+            hasher.final(&digest);
+            std.mem.doNotOptimizeAway(digest);
+            stats.hash_ns += timer.read();
+            stats.symlinks += 1;
+            continue;
+        }
+
+        const file = try root.openFile(item.path, .{});
+        defer file.close();
+        const executable = (try file.stat()).mode & 0o100 != 0;
+        const contents = try file.readToEndAlloc(arena, 1 << 30);
+        defer arena.free(contents);
+
+        var timer = try std.time.Timer.start();
+        var hasher = Sha256.init(.{});
+        hasher.update(item.path);
+        hasher.update(&.{ 0, @intFromBool(executable) });
+        hasher.update(contents);
+        hasher.final(&digest);
+        std.mem.doNotOptimizeAway(digest);
+        stats.hash_ns += timer.read();
+
+        var content_digest: [Sha256.digest_length]u8 = undefined;
+        Sha256.hash(contents, &content_digest, .{});
+        if ((try seen.getOrPut(content_digest)).found_existing) stats.duplicate_bytes += contents.len;
+
+        stats.files += 1;
+        stats.bytes += contents.len;
+        if (std.mem.endsWith(u8, item.path, ".tbd")) stats.stub_bytes += contents.len;
+    }
+
+    var total: Stats = .{ .name = "total" };
+    for (subtrees.values()) |stats| total.accumulate(stats);
+    return .{ .total = total, .subtrees = subtrees.values() };
+}
+
+/// `Frameworks/<name>.framework`, `include/<dir>`, `include` for the loose
+/// top-level headers, and `lib`.
+fn subtreeName(path: []const u8) []const u8 {
+    const first = std.mem.indexOfScalar(u8, path, '/') orelse return path;
+    if (std.mem.eql(u8, path[0..first], "lib")) return "lib";
+    const second = std.mem.indexOfScalarPos(u8, path, first + 1, '/') orelse return path[0..first];
+    return path[0..second];
+}
+
+fn baselineEntry(stats: Stats) BaselineEntry {
+    return .{
+        .name = stats.name,
+        .files = stats.files,
+        .bytes = stats.bytes,
+        .duplicate_bytes = stats.duplicate_bytes,
+        .symlinks = stats.symlinks,
+        .stub_bytes = stats.stub_bytes,
+    };
+}
+
+fn printTable(writer: anytype, report: Report) !void {
+    try writer.print("{s:<48} {s:>7} {s:>12} {s:>12} {s:>6} {s:>12} {s:>10}\n", .{
+        "subtree", "files", "bytes", "dup bytes", "links", "stub bytes", "hash ms",
+    });
+    for (report.subtrees) |stats| try printRow(writer, stats);
+    try printRow(writer, report.total);
+}
+
+fn printRow(writer: anytype, stats: Stats) !void {
+    try writer.print("{s:<48} {d:>7} {d:>12} {d:>12} {d:>6} {d:>12} {d:>10.2}\n", .{
+        stats.name,
+        stats.files,
+        stats.bytes,
+        stats.duplicate_bytes,
+        stats.symlinks,
+        stats.stub_bytes,
+        @as(f64, @floatFromInt(stats.hash_ns)) / std.time.ns_per_ms,
+    });
+}
+
+/// Prints every size that changed against the baseline and returns whether
+/// any subtree in the baseline, or those subtrees together, grew by more
+/// than `tolerance` percent. New subtrees are listed but never fail the
+/// comparison, so shipping a framework only needs a baseline update.
+fn compare(
+    writer: anytype,
+    arena: std.mem.Allocator,
+    baseline: Baseline,
+    report: Report,
+    tolerance: f64,
+) !bool {
+    var old = std.StringHashMap(BaselineEntry).init(arena);
+    for (baseline.subtrees) |entry| try old.put(entry.name, entry);
+
+    var regressed = false;
+    var added_bytes: u64 = 0;
+    try writer.print("\nchanges against baseline:\n", .{});
+    for (report.subtrees) |stats| {
+        const entry = old.fetchRemove(stats.name) orelse {
+            try writer.print("  + {s}: {d} bytes, {d} files\n", .{ stats.name, stats.bytes, stats.files });
+            added_bytes += stats.bytes;
+            continue;
+        };
+        if (try printChange(writer, entry.value, baselineEntry(stats), tolerance)) regressed = true;
+    }
+    var removed = old.valueIterator();
+    while (removed.next()) |entry| {
+        try writer.print("  - {s}: {d} bytes, {d} files\n", .{ entry.name, entry.bytes, entry.files });
+    }
+    _ = try printChange(writer, baseline.total, baselineEntry(report.total), tolerance);
+    if (growth(baseline.total.bytes, report.total.bytes - added_bytes) > tolerance) regressed = true;
+    return regressed;
+}
+
+/// Growth from `old` to `new` bytes in percent.
+fn growth(old: u64, new: u64) f64 {
+    if (old == 0) return if (new == 0) 0.0 else 100.0;
+    const delta = @as(i64, @intCast(new)) - @as(i64, @intCast(old));
+    return 100.0 * @as(f64, @floatFromInt(delta)) / @as(f64, @floatFromInt(old));
+}
+
+fn printChange(writer: anytype, old: BaselineEntry, new: BaselineEntry, tolerance: f64) !bool {
+    if (old.files == new.files and old.bytes == new.bytes and
+        old.duplicate_bytes == new.duplicate_bytes and old.symlinks == new.symlinks and
+        old.stub_bytes == new.stub_bytes) return false;
+    const pct = growth(old.bytes, new.bytes);
+    try writer.print("  ~ {s}: bytes {d} -> {d} ({d:.2}%), files {d} -> {d}, dup bytes {d} -> {d}, links {d} -> {d}, stub bytes {d} -> {d}\n", .{
+        new.name,          old.bytes,    new.bytes,    pct,
+        old.files,         new.files,    old.duplicate_bytes, new.duplicate_bytes,
+        old.symlinks,      new.symlinks, old.stub_bytes,      new.stub_bytes,
+    });
+    return pct > tolerance;
+}
+
+test "a new subtree is reported without failing the comparison" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const metal: BaselineEntry = .{ .name = "Frameworks/Metal.framework", .files = 10, .bytes = 1000, .duplicate_bytes = 0, .symlinks = 2, .stub_bytes = 100 };
+    const baseline: Baseline = .{
+        .total = .{ .name = "total", .files = 10, .bytes = 1000, .duplicate_bytes = 0, .symlinks = 2, .stub_bytes = 100 },
+        .subtrees = &.{metal},
+    };
+    var output = std.ArrayList(u8).init(arena);
+
+    const added: Report = .{
+        .total = .{ .name = "total", .files = 30, .bytes = 6000, .symlinks = 2, .stub_bytes = 100 },
+        .subtrees = &.{
+            .{ .name = "Frameworks/Accelerate.framework", .files = 20, .bytes = 5000 },
+            .{ .name = "Frameworks/Metal.framework", .files = 10, .bytes = 1000, .symlinks = 2, .stub_bytes = 100 },
+        },
+    };
+    try std.testing.expect(!try compare(output.writer(), arena, baseline, added, 1.0));
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "+ Frameworks/Accelerate.framework: 5000 bytes") != null);
+
+    const grown: Report = .{
+        .total = .{ .name = "total", .files = 10, .bytes = 1100, .symlinks = 2, .stub_bytes = 100 },
+        .subtrees = &.{
+            .{ .name = "Frameworks/Metal.framework", .files = 10, .bytes = 1100, .symlinks = 2, .stub_bytes = 100 },
+        },
+    };
+    try std.testing.expect(try compare(output.writer(), arena, baseline, grown, 1.0));
+    try std.testing.expect(!try compare(output.writer(), arena, baseline, grown, 20.0));
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,476 @@
+//! Zig counterparts of the vector, matrix and quaternion types of
+//! `<simd/simd.h>` and of the structures of `<Spatial/Spatial.h>`, with the
+//! size and alignment clang gives them on macOS, so values can be copied into
+//! Metal buffers or passed to C functions as they are. `zig build simd-abi`
+//! checks every layout against the headers for aarch64 and x86_64.
+//!
+//! Vectors are `@Vector`s, so arithmetic and comparison operators apply to
+//! them directly. Zig may align a vector more strictly than C does, e.g.
+//! `double3` to 32 bytes instead of 16. The fields of the structures below
+//! are aligned to `alignment(T)` instead, and pointers into memory laid out by
+//! C should be `*align(alignment(T)) T`.
+
+const std = @import("std");
+
+pub const char2 = @Vector(2, i8);
+pub const char3 = @Vector(3, i8);
+pub const char4 = @Vector(4, i8);
+pub const char8 = @Vector(8, i8);
+pub const char16 = @Vector(16, i8);
+pub const char32 = @Vector(32, i8);
+pub const char64 = @Vector(64, i8);
+
+pub const uchar2 = @Vector(2, u8);
+pub const uchar3 = @Vector(3, u8);
+pub const uchar4 = @Vector(4, u8);
+pub const uchar8 = @Vector(8, u8);
+pub const uchar16 = @Vector(16, u8);
+pub const uchar32 = @Vector(32, u8);
+pub const uchar64 = @Vector(64, u8);
+
+pub const short2 = @Vector(2, i16);
+pub const short3 = @Vector(3, i16);
+pub const short4 = @Vector(4, i16);
+pub const short8 = @Vector(8, i16);
+pub const short16 = @Vector(16, i16);
+pub const short32 = @Vector(32, i16);
+
+pub const ushort2 = @Vector(2, u16);
+pub const ushort3 = @Vector(3, u16);
+pub const ushort4 = @Vector(4, u16);
+pub const ushort8 = @Vector(8, u16);
+pub const ushort16 = @Vector(16, u16);
+pub const ushort32 = @Vector(32, u16);
+
+pub const half2 = @Vector(2, f16);
+pub const half3 = @Vector(3, f16);
+pub const half4 = @Vector(4, f16);
+pub const half8 = @Vector(8, f16);
+pub const half16 = @Vector(16, f16);
+pub const half32 = @Vector(32, f16);
+
+pub const int2 = @Vector(2, i32);
+pub const int3 = @Vector(3, i32);
+pub const int4 = @Vector(4, i32);
+pub const int8 = @Vector(8, i32);
+pub const int16 = @Vector(16, i32);
+
+pub const uint2 = @Vector(2, u32);
+pub const uint3 = @Vector(3, u32);
+pub const uint4 = @Vector(4, u32);
+pub const uint8 = @Vector(8, u32);
+pub const uint16 = @Vector(16, u32);
+
+pub const float2 = @Vector(2, f32);
+pub const float3 = @Vector(3, f32);
+pub const float4 = @Vector(4, f32);
+pub const float8 = @Vector(8, f32);
+pub const float16 = @Vector(16, f32);
+
+pub const long2 = @Vector(2, i64);
+pub const long3 = @Vector(3, i64);
+pub const long4 = @Vector(4, i64);
+pub const long8 = @Vector(8, i64);
+
+pub const ulong2 = @Vector(2, u64);
+pub const ulong3 = @Vector(3, u64);
+pub const ulong4 = @Vector(4, u64);
+pub const ulong8 = @Vector(8, u64);
+
+pub const double2 = @Vector(2, f64);
+pub const double3 = @Vector(3, f64);
+pub const double4 = @Vector(4, f64);
+pub const double8 = @Vector(8, f64);
+
+pub const half2x2 = Matrix(f16, 2, 2);
+pub const half3x2 = Matrix(f16, 3, 2);
+pub const half4x2 = Matrix(f16, 4, 2);
+pub const half2x3 = Matrix(f16, 2, 3);
+pub const half3x3 = Matrix(f16, 3, 3);
+pub const half4x3 = Matrix(f16, 4, 3);
+pub const half2x4 = Matrix(f16, 2, 4);
+pub const half3x4 = Matrix(f16, 3, 4);
+pub const half4x4 = Matrix(f16, 4, 4);
+
+pub const float2x2 = Matrix(f32, 2, 2);
+pub const float3x2 = Matrix(f32, 3, 2);
+pub const float4x2 = Matrix(f32, 4, 2);
+pub const float2x3 = Matrix(f32, 2, 3);
+pub const float3x3 = Matrix(f32, 3, 3);
+pub const float4x3 = Matrix(f32, 4, 3);
+pub const float2x4 = Matrix(f32, 2, 4);
+pub const float3x4 = Matrix(f32, 3, 4);
+pub const float4x4 = Matrix(f32, 4, 4);
+
+pub const double2x2 = Matrix(f64, 2, 2);
+pub const double3x2 = Matrix(f64, 3, 2);
+pub const double4x2 = Matrix(f64, 4, 2);
+pub const double2x3 = Matrix(f64, 2, 3);
+pub const double3x3 = Matrix(f64, 3, 3);
+pub const double4x3 = Matrix(f64, 4, 3);
+pub const double2x4 = Matrix(f64, 2, 4);
+pub const double3x4 = Matrix(f64, 3, 4);
+pub const double4x4 = Matrix(f64, 4, 4);
+
+pub const quath = Quaternion(f16);
+pub const quatf = Quaternion(f32);
+pub const quatd = Quaternion(f64);
+
+/// The alignment of `T` in C. Vectors are aligned to their size rounded up
+/// to a power of two, but to no more than 16 bytes.
+pub fn alignment(comptime T: type) comptime_int {
+    return switch (@typeInfo(T)) {
+        .vector => @min(std.math.ceilPowerOfTwoAssert(usize, @sizeOf(T)), 16),
+        else => @alignOf(T),
+    };
+}
+
+/// A matrix of `c` columns and `r` rows, stored column by column like
+/// `simd_<scalar><c>x<r>`.
+pub fn Matrix(comptime T: type, comptime c: comptime_int, comptime r: comptime_int) type {
+    return extern struct {
+        columns: [c]Column align(alignment(Column)),
+
+        pub const Scalar = T;
+        pub const Column = @Vector(r, T);
+        pub const column_count = c;
+        pub const row_count = r;
+
+        pub const identity = diagonal(@splat(1));
+
+        /// The matrix with `d` on its diagonal and zeros elsewhere.
+        pub fn diagonal(d: @Vector(@min(c, r), T)) @This() {
+            var m = std.mem.zeroes(@This());
+            inline for (0..@min(c, r)) |i| m.columns[i][i] = d[i];
+            return m;
+        }
+    };
+}
+
+/// A quaternion, stored like `simd_quat<scalar>`.
+pub fn Quaternion(comptime T: type) type {
+    return extern struct {
+        /// The imaginary part in the first three lanes and the real part in
+        /// the last one.
+        vector: Vector align(alignment(Vector)),
+
+        pub const Scalar = T;
+        pub const Vector = @Vector(4, T);
+
+        pub const identity: @This() = .{ .vector = .{ 0, 0, 0, 1 } };
+
+        /// The rotation by `radians` around the unit vector `axis`.
+        pub fn init(radians: T, axis: @Vector(3, T)) @This() {
+            const s = @sin(radians / 2);
+            return .{ .vector = .{ axis[0] * s, axis[1] * s, axis[2] * s, @cos(radians / 2) } };
+        }
+
+        pub fn real(q: @This()) T {
+            return q.vector[3];
+        }
+
+        pub fn imag(q: @This()) @Vector(3, T) {
+            return .{ q.vector[0], q.vector[1], q.vector[2] };
+        }
+
+        pub fn conjugate(q: @This()) @This() {
+            return .{ .vector = q.vector * Vector{ -1, -1, -1, 1 } };
+        }
+
+        /// `v` rotated by the unit quaternion `q`.
+        pub fn act(q: @This(), v: @Vector(3, T)) @Vector(3, T) {
+            const V = @Vector(3, T);
+            const u = q.imag();
+            const t = cross(u, v) + @as(V, @splat(q.real())) * v;
+            return v + @as(V, @splat(2)) * cross(u, t);
+        }
+    };
+}
+
+pub inline fn dot(a: anytype, b: @TypeOf(a)) @typeInfo(@TypeOf(a)).vector.child {
+    return @reduce(.Add, a * b);
+}
+
+pub inline fn length(v: anytype) @typeInfo(@TypeOf(v)).vector.child {
+    return @sqrt(dot(v, v));
+}
+
+pub inline fn cross(a: anytype, b: @TypeOf(a)) @TypeOf(a) {
+    return .{
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0],
+    };
+}
+
+/// `x` scaled to unit length, for vectors and quaternions.
+pub inline fn normalize(x: anytype) @TypeOf(x) {
+    const X = @TypeOf(x);
+    if (comptime isQuaternion(X)) return .{ .vector = normalize(x.vector) };
+    return x / @as(X, @splat(length(x)));
+}
+
+/// Like `simd_mul`: the product of two matrices, of a matrix and a column
+/// vector, or of two quaternions.
+pub inline fn mul(a: anytype, b: anytype) Product(@TypeOf(a), @TypeOf(b)) {
+    const A = @TypeOf(a);
+    if (comptime isQuaternion(A)) {
+        const V = @Vector(3, A.Scalar);
+        const u = a.imag();
+        const v = b.imag();
+        const i = @as(V, @splat(a.real())) * v + @as(V, @splat(b.real())) * u + cross(u, v);
+        return .{ .vector = .{ i[0], i[1], i[2], a.real() * b.real() - dot(u, v) } };
+    }
+    if (comptime @typeInfo(@TypeOf(b)) == .vector) return combine(a, b);
+    var result: Product(A, @TypeOf(b)) = undefined;
+    inline for (&result.columns, b.columns) |*column, v| column.* = combine(a, v);
+    return result;
+}
+
+fn Product(comptime A: type, comptime B: type) type {
+    if (isQuaternion(A) and A == B) return A;
+    if (isMatrix(A) and B == @Vector(A.column_count, A.Scalar)) return A.Column;
+    if (isMatrix(A) and isMatrix(B) and B.Scalar == A.Scalar and B.row_count == A.column_count) {
+        return Matrix(A.Scalar, B.column_count, A.row_count);
+    }
+    @compileError("cannot multiply " ++ @typeName(A) ++ " by " ++ @typeName(B));
+}
+
+/// The columns of `m` weighted by the lanes of `v`.
+inline fn combine(m: anytype, v: @Vector(@TypeOf(m).column_count, @TypeOf(m).Scalar)) @TypeOf(m).Column {
+    const Column = @TypeOf(m).Column;
+    var sum: Column = @splat(0);
+    inline for (m.columns, 0..) |column, i| sum += column * @as(Column, @splat(v[i]));
+    return sum;
+}
+
+pub inline fn transpose(m: anytype) Matrix(@TypeOf(m).Scalar, @TypeOf(m).row_count, @TypeOf(m).column_count) {
+    const M = @TypeOf(m);
+    var result: Matrix(M.Scalar, M.row_count, M.column_count) = undefined;
+    inline for (0..M.row_count) |i| {
+        inline for (0..M.column_count) |j| result.columns[i][j] = m.columns[j][i];
+    }
+    return result;
+}
+
+/// The inverse of a square matrix or of a quaternion.
+pub inline fn inverse(x: anytype) @TypeOf(x) {
+    const X = @TypeOf(x);
+    if (comptime isQuaternion(X)) {
+        return .{ .vector = x.conjugate().vector / @as(X.Vector, @splat(dot(x.vector, x.vector))) };
+    }
+    if (comptime !isMatrix(X) or X.column_count != X.row_count) {
+        @compileError("expected a square matrix or a quaternion, found " ++ @typeName(X));
+    }
+    return switch (X.column_count) {
+        2 => inverse2(x),
+        3 => inverse3(x),
+        4 => inverse4(x),
+        else => unreachable,
+    };
+}
+
+fn inverse2(m: anytype) @TypeOf(m) {
+    const Column = @TypeOf(m).Column;
+    const a = m.columns[0];
+    const b = m.columns[1];
+    const det: Column = @splat(a[0] * b[1] - b[0] * a[1]);
+    return .{ .columns = .{ Column{ b[1], -a[1] } / det, Column{ -b[0], a[0] } / det } };
+}
+
+/// The rows of the inverse are the cross products of the other two columns,
+/// divided by the determinant.
+fn inverse3(m: anytype) @TypeOf(m) {
+    const M = @TypeOf(m);
+    const a = m.columns[0];
+    const b = m.columns[1];
+    const c = m.columns[2];
+    const rows = transpose(M{ .columns = .{ cross(b, c), cross(c, a), cross(a, b) } });
+    const det: M.Column = @splat(dot(a, cross(b, c)));
+    return .{ .columns = .{ rows.columns[0] / det, rows.columns[1] / det, rows.columns[2] / det } };
+}
+
+/// Cofactor expansion sharing the 2x2 minors of the first two and the last
+/// two columns.
+fn inverse4(m: anytype) @TypeOf(m) {
+    const M = @TypeOf(m);
+    const e = m.columns;
+    const s0 = e[0][0] * e[1][1] - e[1][0] * e[0][1];
+    const s1 = e[0][0] * e[1][2] - e[1][0] * e[0][2];
+    const s2 = e[0][0] * e[1][3] - e[1][0] * e[0][3];
+    const s3 = e[0][1] * e[1][2] - e[1][1] * e[0][2];
+    const s4 = e[0][1] * e[1][3] - e[1][1] * e[0][3];
+    const s5 = e[0][2] * e[1][3] - e[1][2] * e[0][3];
+    const c5 = e[2][2] * e[3][3] - e[3][2] * e[2][3];
+    const c4 = e[2][1] * e[3][3] - e[3][1] * e[2][3];
+    const c3 = e[2][1] * e[3][2] - e[3][1] * e[2][2];
+    const c2 = e[2][0] * e[3][3] - e[3][0] * e[2][3];
+    const c1 = e[2][0] * e[3][2] - e[3][0] * e[2][2];
+    const c0 = e[2][0] * e[3][1] - e[3][0] * e[2][1];
+    const det: M.Column = @splat(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+    return .{ .columns = .{
+        M.Column{
+            e[1][1] * c5 - e[1][2] * c4 + e[1][3] * c3,
+            -e[0][1] * c5 + e[0][2] * c4 - e[0][3] * c3,
+            e[3][1] * s5 - e[3][2] * s4 + e[3][3] * s3,
+            -e[2][1] * s5 + e[2][2] * s4 - e[2][3] * s3,
+        } / det,
+        M.Column{
+            -e[1][0] * c5 + e[1][2] * c2 - e[1][3] * c1,
+            e[0][0] * c5 - e[0][2] * c2 + e[0][3] * c1,
+            -e[3][0] * s5 + e[3][2] * s2 - e[3][3] * s1,
+            e[2][0] * s5 - e[2][2] * s2 + e[2][3] * s1,
+        } / det,
+        M.Column{
+            e[1][0] * c4 - e[1][1] * c2 + e[1][3] * c0,
+            -e[0][0] * c4 + e[0][1] * c2 - e[0][3] * c0,
+            e[3][0] * s4 - e[3][1] * s2 + e[3][3] * s0,
+            -e[2][0] * s4 + e[2][1] * s2 - e[2][3] * s0,
+        } / det,
+        M.Column{
+            -e[1][0] * c3 + e[1][1] * c1 - e[1][2] * c0,
+            e[0][0] * c3 - e[0][1] * c1 + e[0][2] * c0,
+            -e[3][0] * s3 + e[3][1] * s1 - e[3][2] * s0,
+            e[2][0] * s3 - e[2][1] * s1 + e[2][2] * s0,
+        } / det,
+    } };
+}
+
+/// Like `simd_slerp`: spherical linear interpolation along the shorter arc
+/// between the unit quaternions `q0` and `q1`.
+pub fn slerp(q0: anytype, q1: @TypeOf(q0), t: @TypeOf(q0).Scalar) @TypeOf(q0) {
+    const Q = @TypeOf(q0);
+    // The angle is computed in single precision for half quaternions.
+    const F = if (Q.Scalar == f16) f32 else Q.Scalar;
+    const V = @Vector(4, F);
+    const a: V = @floatCast(q0.vector);
+    var b: V = @floatCast(q1.vector);
+    if (dot(a, b) < 0) b = -b;
+    // Unlike acos of the dot product, this stays accurate for small angles.
+    const angle = 2 * std.math.atan2(length(a - b), length(a + b));
+    const sin_angle = @sin(angle);
+    const u: F = t;
+    const v: V = if (sin_angle < std.math.floatEps(F))
+        a + (b - a) * @as(V, @splat(u))
+    else
+        a * @as(V, @splat(@sin((1 - u) * angle) / sin_angle)) +
+            b * @as(V, @splat(@sin(u * angle) / sin_angle));
+    return normalize(Q{ .vector = @floatCast(v) });
+}
+
+fn isMatrix(comptime T: type) bool {
+    return @typeInfo(T) == .@"struct" and @hasDecl(T, "Column");
+}
+
+fn isQuaternion(comptime T: type) bool {
+    return @typeInfo(T) == .@"struct" and @hasDecl(T, "Vector") and @hasDecl(T, "conjugate");
+}
+
+// Spatial
+
+pub const Angle = extern struct {
+    radians: f64,
+};
+
+pub const RotationAxis3D = extern struct {
+    vector: double3 align(alignment(double3)),
+};
+
+pub const Rotation3D = extern struct {
+    quaternion: quatd,
+};
+
+pub const Point3D = extern struct {
+    vector: double3 align(alignment(double3)),
+};
+
+pub const Vector3D = extern struct {
+    vector: double3 align(alignment(double3)),
+};
+
+pub const Size3D = extern struct {
+    vector: double3 align(alignment(double3)),
+};
+
+pub const Rect3D = extern struct {
+    origin: Point3D,
+    size: Size3D,
+};
+
+pub const Ray3D = extern struct {
+    origin: Point3D,
+    direction: Vector3D,
+};
+
+pub const Pose3D = extern struct {
+    position: Point3D,
+    rotation: Rotation3D,
+};
+
+pub const ScaledPose3D = extern struct {
+    position: Point3D,
+    rotation: Rotation3D,
+    scale: f64,
+};
+
+pub const AffineTransform3D = extern struct {
+    matrix: double4x3,
+};
+
+pub const ProjectiveTransform3D = extern struct {
+    matrix: double4x4,
+};
+
+/// Shares its storage with a `double3` in C, hence the alignment.
+pub const SphericalCoordinates3D = extern struct {
+    radius: f64 align(16),
+    inclination: Angle,
+    azimuth: Angle,
+    _padding: f64 = 0,
+};
+
+fn expectApproxEqual(expected: anytype, actual: @TypeOf(expected)) !void {
+    const T = @TypeOf(expected);
+    if (comptime isQuaternion(T)) return expectApproxEqual(expected.vector, actual.vector);
+    if (comptime isMatrix(T)) {
+        for (expected.columns, actual.columns) |e, a| try expectApproxEqual(e, a);
+        return;
+    }
+    for (0..@typeInfo(T).vector.len) |i| try std.testing.expectApproxEqAbs(expected[i], actual[i], 1e-6);
+}
+
+test "mul" {
+    // Column-major: the columns of [[4, 7], [2, 6]].
+    const m = float2x2{ .columns = .{ .{ 4, 2 }, .{ 7, 6 } } };
+    try expectApproxEqual(float2{ 11, 8 }, mul(m, float2{ 1, 1 }));
+    const n = float2x2{ .columns = .{ .{ 1, 0 }, .{ 1, 1 } } };
+    try expectApproxEqual(float2x2{ .columns = .{ .{ 4, 2 }, .{ 11, 8 } } }, mul(m, n));
+    const translation = float4x4{ .columns = .{ .{ 1, 0, 0, 0 }, .{ 0, 1, 0, 0 }, .{ 0, 0, 1, 0 }, .{ 1, 2, 3, 1 } } };
+    try expectApproxEqual(float4{ 2, 4, 6, 1 }, mul(translation, float4{ 1, 2, 3, 1 }));
+    // i * j = k
+    try expectApproxEqual(quatf{ .vector = .{ 0, 0, 1, 0 } }, mul(quatf{ .vector = .{ 1, 0, 0, 0 } }, quatf{ .vector = .{ 0, 1, 0, 0 } }));
+}
+
+test "inverse" {
+    const m2 = float2x2{ .columns = .{ .{ 4, 2 }, .{ 7, 6 } } };
+    try expectApproxEqual(float2x2{ .columns = .{ .{ 0.6, -0.2 }, .{ -0.7, 0.4 } } }, inverse(m2));
+    const m3 = float3x3.diagonal(.{ 2, 4, 8 });
+    try expectApproxEqual(float3x3.diagonal(.{ 0.5, 0.25, 0.125 }), inverse(m3));
+    const m4 = double4x4{ .columns = .{ .{ 1, 0, 0, 0 }, .{ 0, 1, 0, 0 }, .{ 0, 0, 1, 0 }, .{ 1, 2, 3, 1 } } };
+    try expectApproxEqual(double4x4{ .columns = .{ .{ 1, 0, 0, 0 }, .{ 0, 1, 0, 0 }, .{ 0, 0, 1, 0 }, .{ -1, -2, -3, 1 } } }, inverse(m4));
+    const skewed = double4x4{ .columns = .{ .{ 2, 1, 0, 0 }, .{ 1, 3, 1, 0 }, .{ 0, 1, 4, 1 }, .{ 0, 0, 1, 5 } } };
+    try expectApproxEqual(double4x4.identity, mul(skewed, inverse(skewed)));
+    const q = quatf.init(std.math.pi / 3.0, .{ 0, 0, 1 });
+    try expectApproxEqual(quatf.identity, mul(q, inverse(q)));
+    try expectApproxEqual(q.conjugate(), inverse(q));
+}
+
+test "slerp" {
+    const q0 = quatf.identity;
+    const q1 = quatf.init(std.math.pi / 2.0, .{ 0, 0, 1 });
+    try expectApproxEqual(q0, slerp(q0, q1, 0));
+    try expectApproxEqual(q1, slerp(q0, q1, 1));
+    try expectApproxEqual(quatf.init(std.math.pi / 4.0, .{ 0, 0, 1 }), slerp(q0, q1, 0.5));
+    // The shorter arc: -q1 is the same rotation.
+    try expectApproxEqual(quatf.init(std.math.pi / 4.0, .{ 0, 0, 1 }), slerp(q0, quatf{ .vector = -q1.vector }, 0.5));
+}
@@ -0,0 +1,61 @@
+//! Compares the size and alignment of every type of the `simd` module that
+//! `simd_layout.h` lists with the layout clang computed from the SDK headers,
+//! so that `zig build simd-abi` fails for the target whose layout differs.
+//! Sizes and the alignment of the structures are the ones Zig actually
+//! gives the types. Zig may align a vector more strictly than C, so a vector
+//! only needs an alignment that C's divides, and the alignment the structures
+//! declare for their vector fields, `simd.alignment`, must equal C's. The
+//! Spatial structures must also place every field where C does, and list
+//! all their fields there.
+
+const std = @import("std");
+const simd = @import("simd");
+const c = @import("c");
+
+pub fn main() void {
+    comptime checkLayouts();
+    comptime checkOffsets();
+}
+
+fn checkLayouts() void {
+    @setEvalBranchQuota(10_000_000);
+    for (std.meta.declarations(c)) |decl| {
+        if (!std.mem.startsWith(u8, decl.name, "layout_") or !std.mem.endsWith(u8, decl.name, "_size")) continue;
+        const name = decl.name["layout_".len .. decl.name.len - "_size".len];
+        const T = @field(simd, name);
+        const size = @field(c, decl.name);
+        const alignment = @field(c, "layout_" ++ name ++ "_align");
+        const matches = if (@typeInfo(T) == .vector)
+            @alignOf(T) % alignment == 0 and simd.alignment(T) == alignment
+        else
+            @alignOf(T) == alignment;
+        if (@sizeOf(T) != size or !matches) @compileError(std.fmt.comptimePrint(
+            "{s}: size {d} and alignment {d} (declared for fields {d}) in Zig, {d} and {d} in C",
+            .{ name, @sizeOf(T), @alignOf(T), simd.alignment(T), size, alignment },
+        ));
+    }
+}
+
+fn checkOffsets() void {
+    @setEvalBranchQuota(10_000_000);
+    for (std.meta.declarations(c)) |decl| {
+        if (!std.mem.startsWith(u8, decl.name, "offset_")) continue;
+        const rest = decl.name["offset_".len..];
+        // Type names have no underscore, field names may.
+        const split = std.mem.indexOfScalar(u8, rest, '_').?;
+        const name = rest[0..split];
+        const T = @field(simd, name);
+        const field = rest[split + 1 ..];
+        const offset = @field(c, decl.name);
+        if (@offsetOf(T, field) != offset) @compileError(std.fmt.comptimePrint(
+            "{s}.{s}: offset {d} in Zig, {d} in C",
+            .{ name, field, @offsetOf(T, field), offset },
+        ));
+        for (@typeInfo(T).@"struct".fields) |other| {
+            if (!@hasDecl(c, "offset_" ++ name ++ "_" ++ other.name)) @compileError(std.fmt.comptimePrint(
+                "{s}.{s}: offset not checked against C",
+                .{ name, other.name },
+            ));
+        }
+    }
+}
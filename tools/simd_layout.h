@@ -0,0 +1,146 @@
+// Sizes and alignments of the simd and Spatial types, and offsets of the
+// fields of the Spatial structures, as enum constants, which translate-c
+// emits with the values clang computed for the target. Each entry is named
+// after the declaration of tools/simd.zig it is checked against.
+
+#include <stddef.h>
+#include <simd/simd.h>
+#include <Spatial/Spatial.h>
+
+#define LAYOUT(zig, c) layout_##zig##_size = sizeof(c), layout_##zig##_align = _Alignof(c),
+
+enum simd_layout {
+    LAYOUT(char2, simd_char2)
+    LAYOUT(char3, simd_char3)
+    LAYOUT(char4, simd_char4)
+    LAYOUT(char8, simd_char8)
+    LAYOUT(char16, simd_char16)
+    LAYOUT(char32, simd_char32)
+    LAYOUT(char64, simd_char64)
+    LAYOUT(uchar2, simd_uchar2)
+    LAYOUT(uchar3, simd_uchar3)
+    LAYOUT(uchar4, simd_uchar4)
+    LAYOUT(uchar8, simd_uchar8)
+    LAYOUT(uchar16, simd_uchar16)
+    LAYOUT(uchar32, simd_uchar32)
+    LAYOUT(uchar64, simd_uchar64)
+    LAYOUT(short2, simd_short2)
+    LAYOUT(short3, simd_short3)
+    LAYOUT(short4, simd_short4)
+    LAYOUT(short8, simd_short8)
+    LAYOUT(short16, simd_short16)
+    LAYOUT(short32, simd_short32)
+    LAYOUT(ushort2, simd_ushort2)
+    LAYOUT(ushort3, simd_ushort3)
+    LAYOUT(ushort4, simd_ushort4)
+    LAYOUT(ushort8, simd_ushort8)
+    LAYOUT(ushort16, simd_ushort16)
+    LAYOUT(ushort32, simd_ushort32)
+    LAYOUT(half2, simd_half2)
+    LAYOUT(half3, simd_half3)
+    LAYOUT(half4, simd_half4)
+    LAYOUT(half8, simd_half8)
+    LAYOUT(half16, simd_half16)
+    LAYOUT(half32, simd_half32)
+    LAYOUT(int2, simd_int2)
+    LAYOUT(int3, simd_int3)
+    LAYOUT(int4, simd_int4)
+    LAYOUT(int8, simd_int8)
+    LAYOUT(int16, simd_int16)
+    LAYOUT(uint2, simd_uint2)
+    LAYOUT(uint3, simd_uint3)
+    LAYOUT(uint4, simd_uint4)
+    LAYOUT(uint8, simd_uint8)
+    LAYOUT(uint16, simd_uint16)
+    LAYOUT(float2, simd_float2)
+    LAYOUT(float3, simd_float3)
+    LAYOUT(float4, simd_float4)
+    LAYOUT(float8, simd_float8)
+    LAYOUT(float16, simd_float16)
+    LAYOUT(long2, simd_long2)
+    LAYOUT(long3, simd_long3)
+    LAYOUT(long4, simd_long4)
+    LAYOUT(long8, simd_long8)
+    LAYOUT(ulong2, simd_ulong2)
+    LAYOUT(ulong3, simd_ulong3)
+    LAYOUT(ulong4, simd_ulong4)
+    LAYOUT(ulong8, simd_ulong8)
+    LAYOUT(double2, simd_double2)
+    LAYOUT(double3, simd_double3)
+    LAYOUT(double4, simd_double4)
+    LAYOUT(double8, simd_double8)
+    LAYOUT(half2x2, simd_half2x2)
+    LAYOUT(half3x2, simd_half3x2)
+    LAYOUT(half4x2, simd_half4x2)
+    LAYOUT(half2x3, simd_half2x3)
+    LAYOUT(half3x3, simd_half3x3)
+    LAYOUT(half4x3, simd_half4x3)
+    LAYOUT(half2x4, simd_half2x4)
+    LAYOUT(half3x4, simd_half3x4)
+    LAYOUT(half4x4, simd_half4x4)
+    LAYOUT(float2x2, simd_float2x2)
+    LAYOUT(float3x2, simd_float3x2)
+    LAYOUT(float4x2, simd_float4x2)
+    LAYOUT(float2x3, simd_float2x3)
+    LAYOUT(float3x3, simd_float3x3)
+    LAYOUT(float4x3, simd_float4x3)
+    LAYOUT(float2x4, simd_float2x4)
+    LAYOUT(float3x4, simd_float3x4)
+    LAYOUT(float4x4, simd_float4x4)
+    LAYOUT(double2x2, simd_double2x2)
+    LAYOUT(double3x2, simd_double3x2)
+    LAYOUT(double4x2, simd_double4x2)
+    LAYOUT(double2x3, simd_double2x3)
+    LAYOUT(double3x3, simd_double3x3)
+    LAYOUT(double4x3, simd_double4x3)
+    LAYOUT(double2x4, simd_double2x4)
+    LAYOUT(double3x4, simd_double3x4)
+    LAYOUT(double4x4, simd_double4x4)
+    LAYOUT(quath, simd_quath)
+    LAYOUT(quatf, simd_quatf)
+    LAYOUT(quatd, simd_quatd)
+    LAYOUT(Angle, SPAngle)
+    LAYOUT(RotationAxis3D, SPRotationAxis3D)
+    LAYOUT(Rotation3D, SPRotation3D)
+    LAYOUT(Point3D, SPPoint3D)
+    LAYOUT(Vector3D, SPVector3D)
+    LAYOUT(Size3D, SPSize3D)
+    LAYOUT(Rect3D, SPRect3D)
+    LAYOUT(Ray3D, SPRay3D)
+    LAYOUT(Pose3D, SPPose3D)
+    LAYOUT(ScaledPose3D, SPScaledPose3D)
+    LAYOUT(AffineTransform3D, SPAffineTransform3D)
+    LAYOUT(ProjectiveTransform3D, SPProjectiveTransform3D)
+    LAYOUT(SphericalCoordinates3D, SPSphericalCoordinates3D)
+};
+
+// The Zig structures name their fields like the C members, and the vector
+// view of the unions is their only field.
+#define OFFSET(zig, c, field) offset_##zig##_##field = offsetof(c, field),
+
+enum simd_offset {
+    OFFSET(Angle, SPAngle, radians)
+    OFFSET(RotationAxis3D, SPRotationAxis3D, vector)
+    OFFSET(Rotation3D, SPRotation3D, quaternion)
+    OFFSET(Point3D, SPPoint3D, vector)
+    OFFSET(Vector3D, SPVector3D, vector)
+    OFFSET(Size3D, SPSize3D, vector)
+    OFFSET(Rect3D, SPRect3D, origin)
+    OFFSET(Rect3D, SPRect3D, size)
+    OFFSET(Ray3D, SPRay3D, origin)
+    OFFSET(Ray3D, SPRay3D, direction)
+    OFFSET(Pose3D, SPPose3D, position)
+    OFFSET(Pose3D, SPPose3D, rotation)
+    OFFSET(ScaledPose3D, SPScaledPose3D, position)
+    OFFSET(ScaledPose3D, SPScaledPose3D, rotation)
+    OFFSET(ScaledPose3D, SPScaledPose3D, scale)
+    OFFSET(AffineTransform3D, SPAffineTransform3D, matrix)
+    OFFSET(ProjectiveTransform3D, SPProjectiveTransform3D, matrix)
+    OFFSET(SphericalCoordinates3D, SPSphericalCoordinates3D, radius)
+    OFFSET(SphericalCoordinates3D, SPSphericalCoordinates3D, inclination)
+    OFFSET(SphericalCoordinates3D, SPSphericalCoordinates3D, azimuth)
+    OFFSET(SphericalCoordinates3D, SPSphericalCoordinates3D, _padding)
+};
+
+#undef LAYOUT
+#undef OFFSET
@@ -0,0 +1,159 @@
+//! Smoke-tests one framework or `include/` subsystem for one target: runs
+//! translate-c on its C headers, compiles a minimal program using it and
+//! links that against the stubs, timing each stage. The compile writes a
+//! depfile, so the build system reruns a smoke test only when a header it
+//! read changed.
+//!
+//! With `--report`, prints the recorded timings of every smoke test, slowest
+//! framework first.
+//!
+//! Usage: smoke <output-dir> <dep-file> <zig-exe> <sdk-root> <name> <triple> <source> [--translate-c <header>] [<link-args>...]
+//!        smoke --report <timings>...
+
+const std = @import("std");
+
+const Timing = struct {
+    name: []const u8,
+    triple: []const u8,
+    translate_c_ns: u64,
+    compile_ns: u64,
+    link_ns: u64,
+
+    fn total(t: Timing) u64 {
+        return t.translate_c_ns + t.compile_ns + t.link_ns;
+    }
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len >= 2 and std.mem.eql(u8, args[1], "--report")) return report(arena, args[2..]);
+    if (args.len < 8) {
+        fatal("usage: {s} <output-dir> <dep-file> <zig-exe> <sdk-root> <name> <triple> <source> [--translate-c <header>] [<link-args>...]", .{args[0]});
+    }
+    const out_path = args[1];
+    const dep_file = args[2];
+    const zig = args[3];
+    const sdk = args[4];
+    const name = args[5];
+    const triple = args[6];
+    const source = args[7];
+    var header: ?[]const u8 = null;
+    var link_args = args[8..];
+    if (link_args.len >= 2 and std.mem.eql(u8, link_args[0], "--translate-c")) {
+        header = link_args[1];
+        link_args = link_args[2..];
+    }
+
+    try std.fs.cwd().makePath(out_path);
+    const frameworks = try std.fs.path.join(arena, &.{ sdk, "Frameworks" });
+    const include = try std.fs.path.join(arena, &.{ sdk, "include" });
+    const lib = try std.fs.path.join(arena, &.{ sdk, "lib" });
+    const object = try std.fs.path.join(arena, &.{ out_path, "smoke.o" });
+
+    var timing: Timing = .{ .name = name, .triple = triple, .translate_c_ns = 0, .compile_ns = 0, .link_ns = 0 };
+    if (header) |h| {
+        var argv = std.ArrayList([]const u8).init(arena);
+        try argv.appendSlice(&.{ zig, "translate-c", "-target", triple, "-lc", "-F", frameworks, "-isystem", include, h });
+        const translated = try run(arena, name, triple, "translate-c", argv.items, &timing.translate_c_ns);
+        try std.fs.cwd().writeFile(.{
+            .sub_path = try std.fs.path.join(arena, &.{ out_path, "smoke.zig" }),
+            .data = translated,
+        });
+    }
+    // The program includes the translated header too, so the depfile covers
+    // the inputs of both stages.
+    var compile = std.ArrayList([]const u8).init(arena);
+    try compile.appendSlice(&.{ zig, "cc", "-target", triple, "-c", source, "-o", object, "-fblocks", "-iframework", frameworks, "-isystem", include });
+    try compile.appendSlice(&.{ "-MD", "-MF", dep_file });
+    _ = try run(arena, name, triple, "compile", compile.items, &timing.compile_ns);
+    const bin = try std.fs.path.join(arena, &.{ out_path, "smoke" });
+    var link = std.ArrayList([]const u8).init(arena);
+    try link.appendSlice(&.{ zig, "cc", "-target", triple, object, "-o", bin, "-F", frameworks, "-L", lib });
+    try link.appendSlice(link_args);
+    _ = try run(arena, name, triple, "link", link.items, &timing.link_ns);
+
+    try std.fs.cwd().writeFile(.{
+        .sub_path = try std.fs.path.join(arena, &.{ out_path, "timing.txt" }),
+        .data = try std.fmt.allocPrint(arena, "{s} {s} {d} {d} {d}\n", .{
+            timing.name, timing.triple, timing.translate_c_ns, timing.compile_ns, timing.link_ns,
+        }),
+    });
+}
+
+/// Runs one stage, adding its wall time to `ns`, and returns its stdout.
+/// Exits with the stage's diagnostics if it fails.
+fn run(arena: std.mem.Allocator, name: []const u8, triple: []const u8, stage: []const u8, argv: []const []const u8, ns: *u64) ![]const u8 {
+    var timer = try std.time.Timer.start();
+    const result = try std.process.Child.run(.{
+        .allocator = arena,
+        .argv = argv,
+        .max_output_bytes = 256 * 1024 * 1024,
+    });
+    ns.* += timer.read();
+    switch (result.term) {
+        .Exited => |code| if (code == 0) return result.stdout,
+        else => {},
+    }
+    std.io.getStdErr().writeAll(result.stderr) catch {};
+    fatal("{s} ({s}): {s} failed", .{ name, triple, stage });
+}
+
+fn report(arena: std.mem.Allocator, paths: []const []const u8) !void {
+    // Per name, the timings of each target.
+    var by_name = std.StringArrayHashMap(std.ArrayListUnmanaged(Timing)).init(arena);
+    for (paths) |path| {
+        const data = std.fs.cwd().readFileAlloc(arena, path, 4096) catch |err|
+            fatal("unable to read '{s}': {s}", .{ path, @errorName(err) });
+        var fields = std.mem.tokenizeAny(u8, data, " \n");
+        const timing: Timing = .{
+            .name = fields.next() orelse fatal("malformed timings in '{s}'", .{path}),
+            .triple = fields.next() orelse fatal("malformed timings in '{s}'", .{path}),
+            .translate_c_ns = try std.fmt.parseInt(u64, fields.next() orelse "0", 10),
+            .compile_ns = try std.fmt.parseInt(u64, fields.next() orelse "0", 10),
+            .link_ns = try std.fmt.parseInt(u64, fields.next() orelse "0", 10),
+        };
+        const entry = try by_name.getOrPutValue(timing.name, .{});
+        try entry.value_ptr.append(arena, timing);
+    }
+
+    const SortContext = struct {
+        values: []const std.ArrayListUnmanaged(Timing),
+        fn total(timings: std.ArrayListUnmanaged(Timing)) u64 {
+            var sum: u64 = 0;
+            for (timings.items) |t| sum += t.total();
+            return sum;
+        }
+        pub fn lessThan(ctx: @This(), a: usize, b: usize) bool {
+            return total(ctx.values[a]) > total(ctx.values[b]);
+        }
+    };
+    by_name.sort(SortContext{ .values = by_name.values() });
+
+    const stdout = std.io.getStdOut().writer();
+    try stdout.print("{s:<24} {s:<20} {s:>13} {s:>10} {s:>10}\n", .{ "smoke test", "target", "translate-c", "compile", "link" });
+    for (by_name.values()) |timings| {
+        std.mem.sort(Timing, timings.items, {}, struct {
+            fn lessThan(_: void, a: Timing, b: Timing) bool {
+                return std.mem.lessThan(u8, a.triple, b.triple);
+            }
+        }.lessThan);
+        for (timings.items) |t| {
+            try stdout.print("{s:<24} {s:<20} {d:>10.1} ms {d:>7.1} ms {d:>7.1} ms\n", .{
+                t.name, t.triple, ms(t.translate_c_ns), ms(t.compile_ns), ms(t.link_ns),
+            });
+        }
+    }
+}
+
+fn ms(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / std.time.ns_per_ms;
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,184 @@
+//! Materializes a `MacOSX.sdk`-shaped sysroot whose `usr/include`, `usr/lib`
+//! and `System/Library/Frameworks` are symlinks into this package, together
+//! with `zig cc` wrapper scripts and CMake toolchain and Meson cross files
+//! for each given architecture. Everything refers to files by their
+//! path under the output directory, so that the compiler command lines stay
+//! the same across SDK updates and compiler caches keep hitting.
+//!
+//! Usage: sysroot <output-dir> <sdk-root> <zig-exe> <arch>...
+
+const std = @import("std");
+
+const links = [_]struct { []const u8, []const u8 }{
+    .{ "usr/include", "include" },
+    .{ "usr/lib", "lib" },
+    .{ "System/Library/Frameworks", "Frameworks" },
+};
+
+const Target = struct {
+    zig_arch: []const u8,
+    cmake_processor: []const u8,
+};
+
+const targets = [_]Target{
+    .{ .zig_arch = "aarch64", .cmake_processor = "arm64" },
+    .{ .zig_arch = "x86_64", .cmake_processor = "x86_64" },
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 5) fatal("usage: {s} <output-dir> <sdk-root> <zig-exe> <arch>...", .{args[0]});
+    try std.fs.cwd().makePath(args[1]);
+    const out_path = try std.fs.cwd().realpathAlloc(arena, args[1]);
+    const sdk = try std.fs.cwd().realpathAlloc(arena, args[2]);
+    const zig = args[3];
+    var out = try std.fs.cwd().openDir(out_path, .{});
+    defer out.close();
+
+    const sysroot = try std.fs.path.join(arena, &.{ out_path, "MacOSX.sdk" });
+    for (links) |link| {
+        const sub_path = try std.fs.path.join(arena, &.{ "MacOSX.sdk", link[0] });
+        if (std.fs.path.dirname(sub_path)) |parent| try out.makePath(parent);
+        out.deleteFile(sub_path) catch |err| switch (err) {
+            error.FileNotFound => {},
+            else => return err,
+        };
+        try out.symLink(try std.fs.path.join(arena, &.{ sdk, link[1] }), sub_path, .{ .is_directory = true });
+    }
+
+    const version = try sdkVersion(arena, sdk);
+    try writeIfChanged(out, "MacOSX.sdk/SDKSettings.json", try std.fmt.allocPrint(arena,
+        \\{{
+        \\  "CanonicalName": "macosx{s}",
+        \\  "DisplayName": "macOS {s}",
+        \\  "Version": "{s}",
+        \\  "MaximumDeploymentTarget": "{s}.99",
+        \\  "DefaultProperties": {{
+        \\    "PLATFORM_NAME": "macosx"
+        \\  }}
+        \\}}
+        \\
+    , .{ version, version, version, version }));
+
+    try out.makePath("bin");
+    for ([_][]const u8{ "ar", "ranlib" }) |name| {
+        try writeScript(out, try std.fs.path.join(arena, &.{ "bin", name }), try std.fmt.allocPrint(arena,
+            \\#!/bin/sh
+            \\exec '{s}' {s} "$@"
+            \\
+        , .{ zig, name }));
+    }
+
+    const frameworks = try std.fs.path.join(arena, &.{ sysroot, "System", "Library", "Frameworks" });
+    const include = try std.fs.path.join(arena, &.{ sysroot, "usr", "include" });
+    const lib = try std.fs.path.join(arena, &.{ sysroot, "usr", "lib" });
+    for (args[4..]) |arch| {
+        const target = for (targets) |target| {
+            if (std.mem.eql(u8, target.zig_arch, arch)) break target;
+        } else fatal("unsupported architecture '{s}'", .{arch});
+        // -F and -L are for the linker; clang treats the framework directory
+        // as a system one because of -iframework.
+        for ([_][]const u8{ "cc", "c++" }) |driver| {
+            try writeScript(out, try std.fmt.allocPrint(arena, "bin/{s}-macos-{s}", .{ target.zig_arch, driver }), try std.fmt.allocPrint(arena,
+                \\#!/bin/sh
+                \\exec '{s}' {s} -target {s}-macos -iframework '{s}' -isystem '{s}' -F '{s}' -L '{s}' "$@"
+                \\
+            , .{ zig, driver, target.zig_arch, frameworks, include, frameworks, lib }));
+        }
+
+        const cc = try std.fmt.allocPrint(arena, "{s}/bin/{s}-macos-cc", .{ out_path, target.zig_arch });
+        const cxx = try std.fmt.allocPrint(arena, "{s}/bin/{s}-macos-c++", .{ out_path, target.zig_arch });
+        try writeIfChanged(out, try std.fmt.allocPrint(arena, "{s}-macos.cmake", .{target.zig_arch}), try std.fmt.allocPrint(arena,
+            \\# Generated by `zig build sysroot`. Use with
+            \\# -DCMAKE_TOOLCHAIN_FILE=<this file>, and -DCMAKE_C_COMPILER_LAUNCHER=ccache
+            \\# to cache compiles.
+            \\set(CMAKE_SYSTEM_NAME Darwin)
+            \\set(CMAKE_SYSTEM_PROCESSOR {s})
+            \\set(CMAKE_OSX_SYSROOT "{s}")
+            \\set(CMAKE_C_COMPILER "{s}")
+            \\set(CMAKE_CXX_COMPILER "{s}")
+            \\set(CMAKE_OBJC_COMPILER "{s}")
+            \\set(CMAKE_OBJCXX_COMPILER "{s}")
+            \\set(CMAKE_AR "{s}/bin/ar")
+            \\set(CMAKE_RANLIB "{s}/bin/ranlib")
+            \\set(CMAKE_FIND_ROOT_PATH "{s}")
+            \\set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+            \\set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+            \\set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+            \\set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
+            \\
+        , .{ target.cmake_processor, sysroot, cc, cxx, cc, cxx, out_path, out_path, sysroot }));
+        try writeIfChanged(out, try std.fmt.allocPrint(arena, "{s}-macos.ini", .{target.zig_arch}), try std.fmt.allocPrint(arena,
+            \\# Generated by `zig build sysroot`. Use with --cross-file=<this file>;
+            \\# write the compilers as ['ccache', '...'] to cache compiles.
+            \\[binaries]
+            \\c = '{s}'
+            \\cpp = '{s}'
+            \\objc = '{s}'
+            \\objcpp = '{s}'
+            \\ar = '{s}/bin/ar'
+            \\ranlib = '{s}/bin/ranlib'
+            \\
+            \\[properties]
+            \\sys_root = '{s}'
+            \\
+            \\[host_machine]
+            \\system = 'darwin'
+            \\cpu_family = '{s}'
+            \\cpu = '{s}'
+            \\endian = 'little'
+            \\
+        , .{ cc, cxx, cc, cxx, out_path, out_path, sysroot, target.zig_arch, target.zig_arch }));
+    }
+}
+
+/// The newest macOS version `AvailabilityVersions.h` defines, e.g. "15.4".
+fn sdkVersion(arena: std.mem.Allocator, sdk: []const u8) ![]const u8 {
+    const path = try std.fs.path.join(arena, &.{ sdk, "include", "AvailabilityVersions.h" });
+    const bytes = try std.fs.cwd().readFileAlloc(arena, path, 1 << 20);
+    var newest: ?std.SemanticVersion = null;
+    var lines = std.mem.tokenizeScalar(u8, bytes, '\n');
+    while (lines.next()) |line| {
+        const prefix = "#define __MAC_";
+        if (!std.mem.startsWith(u8, line, prefix)) continue;
+        const name = std.mem.tokenizeAny(u8, line[prefix.len..], " \t").next() orelse continue;
+        var parts = std.mem.splitScalar(u8, name, '_');
+        const version: std.SemanticVersion = .{
+            .major = std.fmt.parseInt(usize, parts.next().?, 10) catch continue,
+            .minor = std.fmt.parseInt(usize, parts.next() orelse "0", 10) catch continue,
+            .patch = std.fmt.parseInt(usize, parts.next() orelse "0", 10) catch continue,
+        };
+        if (newest == null or version.order(newest.?) == .gt) newest = version;
+    }
+    const version = newest orelse fatal("no __MAC_ versions in {s}", .{path});
+    return std.fmt.allocPrint(arena, "{d}.{d}", .{ version.major, version.minor });
+}
+
+/// Leaves the file and its mtime alone if the contents are the same, so that
+/// builds watching it are not invalidated.
+fn writeIfChanged(dir: std.fs.Dir, sub_path: []const u8, data: []const u8) !void {
+    var buf: [64 * 1024]u8 = undefined;
+    if (dir.readFile(sub_path, &buf)) |old| {
+        if (std.mem.eql(u8, old, data)) return;
+    } else |err| switch (err) {
+        error.FileNotFound => {},
+        else => return err,
+    }
+    try dir.writeFile(.{ .sub_path = sub_path, .data = data });
+}
+
+fn writeScript(dir: std.fs.Dir, sub_path: []const u8, data: []const u8) !void {
+    try writeIfChanged(dir, sub_path, data);
+    const file = try dir.openFile(sub_path, .{});
+    defer file.close();
+    try file.chmod(0o755);
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
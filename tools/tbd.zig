@@ -0,0 +1,243 @@
+//! Minimal reader for the TAPI v4 text stubs (`.tbd`) shipped in this
+//! package. Only the keys the tools need are kept; everything else is
+//! skipped.
+
+const std = @import("std");
+
+pub const Document = struct {
+    install_name: []const u8 = "",
+    current_version: []const u8 = "1",
+    compatibility_version: []const u8 = "1",
+    targets: []const []const u8 = &.{},
+    reexported_libraries: []const Section = &.{},
+    exports: []const Section = &.{},
+    reexports: []const Section = &.{},
+
+    /// Whether the document has a slice for `target` (e.g. "arm64-macos").
+    pub fn hasTarget(doc: Document, target: []const u8) bool {
+        return contains(doc.targets, target);
+    }
+};
+
+pub const Section = struct {
+    targets: []const []const u8 = &.{},
+    libraries: []const []const u8 = &.{},
+    symbols: []const []const u8 = &.{},
+    weak_symbols: []const []const u8 = &.{},
+    thread_local_symbols: []const []const u8 = &.{},
+    objc_classes: []const []const u8 = &.{},
+    objc_eh_types: []const []const u8 = &.{},
+    objc_ivars: []const []const u8 = &.{},
+
+    pub fn hasTarget(section: Section, target: []const u8) bool {
+        return contains(section.targets, target);
+    }
+};
+
+/// Parses every document of a stub. The first document describes the
+/// library itself; the following ones are libraries it re-exports.
+pub fn parse(arena: std.mem.Allocator, src: []const u8) ![]Document {
+    var docs = std.ArrayList(Document).init(arena);
+    var lines = std.ArrayList([]const u8).init(arena);
+    var split = std.mem.splitScalar(u8, src, '\n');
+    while (split.next()) |line| try lines.append(std.mem.trimRight(u8, line, "\r"));
+
+    var i: usize = 0;
+    while (i < lines.items.len) {
+        const line = lines.items[i];
+        if (std.mem.startsWith(u8, line, "---")) {
+            try docs.append(.{});
+            i += 1;
+            continue;
+        }
+        if (line.len == 0 or line[0] == ' ' or line[0] == '#' or docs.items.len == 0) {
+            i += 1;
+            continue;
+        }
+
+        var end = i + 1;
+        while (end < lines.items.len and lines.items[end].len > 0 and lines.items[end][0] == ' ') end += 1;
+        const block = lines.items[i..end];
+        i = end;
+
+        const doc = &docs.items[docs.items.len - 1];
+        const colon = std.mem.indexOfScalar(u8, line, ':') orelse continue;
+        const key = line[0..colon];
+        const value = try std.mem.join(arena, " ", block);
+        const rest = value[colon + 1 ..];
+        if (std.mem.eql(u8, key, "install-name")) {
+            doc.install_name = unquote(std.mem.trim(u8, rest, " "));
+        } else if (std.mem.eql(u8, key, "current-version")) {
+            doc.current_version = std.mem.trim(u8, rest, " ");
+        } else if (std.mem.eql(u8, key, "compatibility-version")) {
+            doc.compatibility_version = std.mem.trim(u8, rest, " ");
+        } else if (std.mem.eql(u8, key, "targets")) {
+            doc.targets = try flowList(arena, rest);
+        } else if (std.mem.eql(u8, key, "reexported-libraries")) {
+            doc.reexported_libraries = try sections(arena, block[1..]);
+        } else if (std.mem.eql(u8, key, "exports")) {
+            doc.exports = try sections(arena, block[1..]);
+        } else if (std.mem.eql(u8, key, "reexports")) {
+            doc.reexports = try sections(arena, block[1..]);
+        }
+    }
+    return docs.items;
+}
+
+/// Converts a dotted version ("368.11.4") to the packed Mach-O encoding.
+pub fn packVersion(version: []const u8) u32 {
+    var packed_version: u32 = 0;
+    var shift: u5 = 16;
+    var parts = std.mem.splitScalar(u8, version, '.');
+    while (parts.next()) |part| {
+        const n = std.fmt.parseInt(u32, part, 10) catch 0;
+        packed_version |= if (shift == 16) n << 16 else (n & 0xff) << shift;
+        if (shift == 0) break;
+        shift -= 8;
+    }
+    return packed_version;
+}
+
+fn sections(arena: std.mem.Allocator, lines: []const []const u8) ![]const Section {
+    var result = std.ArrayList(Section).init(arena);
+    var start: usize = 0;
+    while (start < lines.len) {
+        var end = start + 1;
+        while (end < lines.len and !isItemStart(lines[end])) end += 1;
+        try result.append(try section(arena, lines[start..end]));
+        start = end;
+    }
+    return result.items;
+}
+
+fn section(arena: std.mem.Allocator, lines: []const []const u8) !Section {
+    var result: Section = .{};
+    var start: usize = 0;
+    while (start < lines.len) {
+        var end = start + 1;
+        while (end < lines.len and !isKeyStart(lines[end])) end += 1;
+        const text = try std.mem.join(arena, " ", lines[start..end]);
+        start = end;
+
+        const trimmed = std.mem.trimLeft(u8, text, " -");
+        const colon = std.mem.indexOfScalar(u8, trimmed, ':') orelse continue;
+        const key = trimmed[0..colon];
+        const list = try flowList(arena, trimmed[colon + 1 ..]);
+        if (std.mem.eql(u8, key, "targets")) {
+            result.targets = list;
+        } else if (std.mem.eql(u8, key, "libraries")) {
+            result.libraries = list;
+        } else if (std.mem.eql(u8, key, "symbols")) {
+            result.symbols = list;
+        } else if (std.mem.eql(u8, key, "weak-symbols")) {
+            result.weak_symbols = list;
+        } else if (std.mem.eql(u8, key, "thread-local-symbols")) {
+            result.thread_local_symbols = list;
+        } else if (std.mem.eql(u8, key, "objc-classes")) {
+            result.objc_classes = list;
+        } else if (std.mem.eql(u8, key, "objc-eh-types")) {
+            result.objc_eh_types = list;
+        } else if (std.mem.eql(u8, key, "objc-ivars")) {
+            result.objc_ivars = list;
+        }
+    }
+    return result;
+}
+
+fn isItemStart(line: []const u8) bool {
+    return std.mem.startsWith(u8, std.mem.trimLeft(u8, line, " "), "- ");
+}
+
+/// Keys of a sequence item start a line with an identifier followed by ':';
+/// continuation lines of a flow list start with a symbol or a quote.
+fn isKeyStart(line: []const u8) bool {
+    const trimmed = std.mem.trimLeft(u8, line, " -");
+    const colon = std.mem.indexOfScalar(u8, trimmed, ':') orelse return false;
+    for (trimmed[0..colon]) |c| {
+        if (!std.ascii.isLower(c) and c != '-') return false;
+    }
+    return colon > 0;
+}
+
+fn flowList(arena: std.mem.Allocator, text: []const u8) ![]const []const u8 {
+    const open = std.mem.indexOfScalar(u8, text, '[') orelse {
+        const single = std.mem.trim(u8, text, " ");
+        if (single.len == 0) return &.{};
+        return try arena.dupe([]const u8, &.{unquote(single)});
+    };
+    const close = std.mem.lastIndexOfScalar(u8, text, ']') orelse text.len;
+    var result = std.ArrayList([]const u8).init(arena);
+    var items = std.mem.tokenizeScalar(u8, text[open + 1 .. close], ',');
+    while (items.next()) |item| {
+        const trimmed = std.mem.trim(u8, item, " ");
+        if (trimmed.len > 0) try result.append(unquote(trimmed));
+    }
+    return result.items;
+}
+
+fn unquote(text: []const u8) []const u8 {
+    if (text.len >= 2 and (text[0] == '\'' or text[0] == '"') and text[text.len - 1] == text[0])
+        return text[1 .. text.len - 1];
+    return text;
+}
+
+fn contains(haystack: []const []const u8, needle: []const u8) bool {
+    for (haystack) |item| {
+        if (std.mem.eql(u8, item, needle)) return true;
+    }
+    return false;
+}
+
+test "parse" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const docs = try parse(arena_state.allocator(),
+        \\--- !tapi-tbd
+        \\tbd-version:     4
+        \\targets:         [ x86_64-macos, arm64-macos,
+        \\                   arm64e-macos ]
+        \\install-name:    '/System/Library/Frameworks/Umbrella.framework/Versions/A/Umbrella'
+        \\current-version: 368.11.4
+        \\reexported-libraries:
+        \\  - targets:         [ arm64-macos ]
+        \\    libraries:       [ '/usr/lib/libinner.dylib' ]
+        \\exports:
+        \\  - targets:         [ x86_64-macos, arm64-macos ]
+        \\    symbols:         [ _a, _b,
+        \\                       _c ]
+        \\    objc-classes:    [ UMBView ]
+        \\  - targets:         [ arm64-macos ]
+        \\    weak-symbols:    [ _w ]
+        \\--- !tapi-tbd
+        \\tbd-version:     4
+        \\targets:         [ arm64-macos ]
+        \\install-name:    '/usr/lib/libinner.dylib'
+        \\exports:
+        \\  - targets:         [ arm64-macos ]
+        \\    thread-local-symbols: [ _tls ]
+        \\...
+        \\
+    );
+    try std.testing.expectEqual(2, docs.len);
+    const umbrella = docs[0];
+    try std.testing.expectEqualStrings("/System/Library/Frameworks/Umbrella.framework/Versions/A/Umbrella", umbrella.install_name);
+    try std.testing.expectEqualStrings("368.11.4", umbrella.current_version);
+    try std.testing.expectEqualStrings("1", umbrella.compatibility_version);
+    try std.testing.expect(umbrella.hasTarget("arm64e-macos"));
+    try std.testing.expect(!umbrella.hasTarget("arm64-maccatalyst"));
+    try std.testing.expectEqual(1, umbrella.reexported_libraries.len);
+    try std.testing.expectEqualStrings("/usr/lib/libinner.dylib", umbrella.reexported_libraries[0].libraries[0]);
+    try std.testing.expectEqual(2, umbrella.exports.len);
+    try std.testing.expectEqual(3, umbrella.exports[0].symbols.len);
+    try std.testing.expectEqualStrings("_c", umbrella.exports[0].symbols[2]);
+    try std.testing.expectEqualStrings("UMBView", umbrella.exports[0].objc_classes[0]);
+    try std.testing.expect(!umbrella.exports[1].hasTarget("x86_64-macos"));
+    try std.testing.expectEqualStrings("_w", umbrella.exports[1].weak_symbols[0]);
+    try std.testing.expectEqualStrings("_tls", docs[1].exports[0].thread_local_symbols[0]);
+}
+
+test "packVersion" {
+    try std.testing.expectEqual(0x01700b04, packVersion("368.11.4"));
+    try std.testing.expectEqual(0x00010000, packVersion("1"));
+    try std.testing.expectEqual(0x00010203, packVersion("1.2.3"));
+}
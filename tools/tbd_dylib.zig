@@ -0,0 +1,603 @@
+//! Converts the `.tbd` text stubs of the package into binary Mach-O stub
+//! dylibs for one architecture. Each stub keeps the install name, the
+//! current and compatibility versions and the re-exports of the text stub,
+//! and carries its exports as an export trie plus a symbol table. Symbols of
+//! re-exported libraries described in the same stub are folded into the
+//! umbrella, mirroring how dyld resolves them through the re-export.
+//!
+//! The output mirrors the package layout with the `.tbd` extension dropped
+//! (`lib/libobjc.dylib`, `Frameworks/AppKit.framework/AppKit`).
+//!
+//! Usage: tbd_dylib <out-dir> <sdk-root> <aarch64|x86_64>
+
+const std = @import("std");
+const tbd = @import("tbd.zig");
+
+const MH_MAGIC_64 = 0xfeedfacf;
+const MH_DYLIB = 0x6;
+const MH_NOUNDEFS = 0x1;
+const MH_DYLDLINK = 0x4;
+const MH_TWOLEVEL = 0x80;
+const MH_NO_REEXPORTED_DYLIBS = 0x100000;
+const LC_REQ_DYLD = 0x80000000;
+const LC_SYMTAB = 0x2;
+const LC_DYSYMTAB = 0xb;
+const LC_ID_DYLIB = 0xd;
+const LC_SEGMENT_64 = 0x19;
+const LC_REEXPORT_DYLIB = 0x1f | LC_REQ_DYLD;
+const LC_DYLD_INFO_ONLY = 0x22 | LC_REQ_DYLD;
+const LC_BUILD_VERSION = 0x32;
+const PLATFORM_MACOS = 1;
+const N_SECT = 0xe;
+const N_EXT = 0x1;
+const N_WEAK_DEF = 0x80;
+const EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL = 0x1;
+const EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION = 0x4;
+
+const Arch = struct {
+    target: []const u8,
+    cputype: u32,
+    cpusubtype: u32,
+    page_size: u64,
+    /// Oldest macOS release for the architecture, in packed encoding.
+    minos: u32,
+};
+
+const aarch64: Arch = .{
+    .target = "arm64-macos",
+    .cputype = 0x0100000c,
+    .cpusubtype = 0,
+    .page_size = 0x4000,
+    .minos = 0x000b0000,
+};
+const x86_64: Arch = .{
+    .target = "x86_64-macos",
+    .cputype = 0x01000007,
+    .cpusubtype = 3,
+    .page_size = 0x1000,
+    .minos = 0x000a0d00,
+};
+
+const Symbol = struct {
+    name: []const u8,
+    flags: u8 = 0,
+
+    fn lessThan(_: void, a: Symbol, b: Symbol) bool {
+        return std.mem.lessThan(u8, a.name, b.name);
+    }
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len != 4) fatal("usage: {s} <out-dir> <sdk-root> <aarch64|x86_64>", .{args[0]});
+    const arch = if (std.mem.eql(u8, args[3], "aarch64"))
+        aarch64
+    else if (std.mem.eql(u8, args[3], "x86_64"))
+        x86_64
+    else
+        fatal("unsupported architecture '{s}'", .{args[3]});
+
+    var out = try std.fs.cwd().makeOpenPath(args[1], .{});
+    defer out.close();
+    var root = try std.fs.cwd().openDir(args[2], .{});
+    defer root.close();
+
+    for ([_][]const u8{ "Frameworks", "lib" }) |top| {
+        var dir = try root.openDir(top, .{ .iterate = true });
+        defer dir.close();
+        var walker = try dir.walk(arena);
+        defer walker.deinit();
+        while (try walker.next()) |entry| {
+            const path = try std.fs.path.join(arena, &.{ top, entry.path });
+            switch (entry.kind) {
+                .sym_link => try mirrorLink(arena, root, out, path),
+                .file => if (std.mem.endsWith(u8, path, ".tbd")) {
+                    const src = try root.readFileAlloc(arena, path, 1 << 30);
+                    const docs = tbd.parse(arena, src) catch |err| {
+                        std.log.warn("skipping '{s}': {s}", .{ path, @errorName(err) });
+                        continue;
+                    };
+                    if (docs.len == 0 or !docs[0].hasTarget(arch.target)) continue;
+                    const bytes = try writeDylib(arena, arch, docs);
+                    const dest = try stubPath(arena, path);
+                    if (std.fs.path.dirname(dest)) |dirname| try out.makePath(dirname);
+                    try out.writeFile(.{ .sub_path = dest, .data = bytes });
+                },
+                else => {},
+            }
+        }
+    }
+}
+
+/// Keeps the framework symlinks (`Versions/Current`, `AppKit.tbd`, nested
+/// `*.framework`) so the stubs are found the same way as the text stubs.
+fn mirrorLink(arena: std.mem.Allocator, root: std.fs.Dir, out: std.fs.Dir, path: []const u8) !void {
+    const basename = std.fs.path.basename(path);
+    if (!std.mem.eql(u8, basename, "Current") and
+        !std.mem.endsWith(u8, basename, ".tbd") and
+        !std.mem.endsWith(u8, basename, ".framework")) return;
+
+    var buf: [std.fs.max_path_bytes]u8 = undefined;
+    const target = try root.readLink(path, &buf);
+    const dest = try stubPath(arena, path);
+    const dest_target = try stubPath(arena, target);
+    if (std.fs.path.dirname(dest)) |dirname| try out.makePath(dirname);
+    out.deleteFile(dest) catch {};
+    try out.symLink(dest_target, dest, .{});
+}
+
+/// `lib/libobjc.tbd` -> `lib/libobjc.dylib`, `AppKit.framework/AppKit.tbd`
+/// -> `AppKit.framework/AppKit`.
+fn stubPath(arena: std.mem.Allocator, path: []const u8) ![]const u8 {
+    if (!std.mem.endsWith(u8, path, ".tbd")) return path;
+    const stem = path[0 .. path.len - ".tbd".len];
+    if (std.mem.startsWith(u8, std.fs.path.basename(stem), "lib"))
+        return std.fmt.allocPrint(arena, "{s}.dylib", .{stem});
+    return stem;
+}
+
+/// Install names re-exported by the stub, directly or through the re-exports
+/// of inlined documents (ApplicationServices re-exports QD, which re-exports
+/// ATSUI), in the order they are reached.
+fn reexportClosure(arena: std.mem.Allocator, arch: Arch, docs: []const tbd.Document) !std.StringArrayHashMap(void) {
+    var closure = std.StringArrayHashMap(void).init(arena);
+    var pending = std.ArrayList(*const tbd.Document).init(arena);
+    try pending.append(&docs[0]);
+    while (pending.pop()) |doc| {
+        for (doc.reexported_libraries) |section| {
+            if (!section.hasTarget(arch.target)) continue;
+            for (section.libraries) |library| {
+                if ((try closure.getOrPut(library)).found_existing) continue;
+                for (docs[1..]) |*inlined| {
+                    if (std.mem.eql(u8, inlined.install_name, library)) try pending.append(inlined);
+                }
+            }
+        }
+    }
+    return closure;
+}
+
+fn collectSymbols(arena: std.mem.Allocator, arch: Arch, docs: []const tbd.Document) ![]Symbol {
+    const reexported = try reexportClosure(arena, arch, docs);
+
+    var seen = std.StringHashMap(void).init(arena);
+    var symbols = std.ArrayList(Symbol).init(arena);
+    for (docs, 0..) |doc, i| {
+        if (i > 0 and !reexported.contains(doc.install_name)) continue;
+        if (!doc.hasTarget(arch.target)) continue;
+        for ([_][]const tbd.Section{ doc.exports, doc.reexports }) |sections| {
+            for (sections) |section| {
+                if (!section.hasTarget(arch.target)) continue;
+                try addSymbols(arena, &symbols, &seen, section.symbols, "", 0);
+                try addSymbols(arena, &symbols, &seen, section.weak_symbols, "", EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION);
+                try addSymbols(arena, &symbols, &seen, section.thread_local_symbols, "", EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL);
+                try addSymbols(arena, &symbols, &seen, section.objc_classes, "_OBJC_CLASS_$_", 0);
+                try addSymbols(arena, &symbols, &seen, section.objc_classes, "_OBJC_METACLASS_$_", 0);
+                try addSymbols(arena, &symbols, &seen, section.objc_eh_types, "_OBJC_EHTYPE_$_", 0);
+                try addSymbols(arena, &symbols, &seen, section.objc_ivars, "_OBJC_IVAR_$_", 0);
+            }
+        }
+    }
+    std.mem.sort(Symbol, symbols.items, {}, Symbol.lessThan);
+    return symbols.items;
+}
+
+fn addSymbols(
+    arena: std.mem.Allocator,
+    symbols: *std.ArrayList(Symbol),
+    seen: *std.StringHashMap(void),
+    names: []const []const u8,
+    prefix: []const u8,
+    flags: u8,
+) !void {
+    for (names) |name| {
+        const full = if (prefix.len == 0) name else try std.mem.concat(arena, u8, &.{ prefix, name });
+        if ((try seen.getOrPut(full)).found_existing) continue;
+        try symbols.append(.{ .name = full, .flags = flags });
+    }
+}
+
+/// Libraries re-exported by the stub, directly or through an inlined
+/// document, that are not folded into it.
+fn externalReexports(arena: std.mem.Allocator, arch: Arch, docs: []const tbd.Document) ![]const []const u8 {
+    var inlined = std.StringHashMap(void).init(arena);
+    for (docs[1..]) |doc| try inlined.put(doc.install_name, {});
+    const closure = try reexportClosure(arena, arch, docs);
+    var result = std.ArrayList([]const u8).init(arena);
+    for (closure.keys()) |library| {
+        if (!inlined.contains(library)) try result.append(library);
+    }
+    return result.items;
+}
+
+fn writeDylib(arena: std.mem.Allocator, arch: Arch, docs: []const tbd.Document) ![]u8 {
+    const doc = docs[0];
+    const symbols = try collectSymbols(arena, arch, docs);
+    const reexports = try externalReexports(arena, arch, docs);
+
+    const segment_size = 72;
+    const section_size = 80;
+    const id_size = dylibCommandSize(doc.install_name);
+    var reexports_size: u32 = 0;
+    for (reexports) |library| reexports_size += dylibCommandSize(library);
+    const sizeofcmds: u32 = (segment_size + section_size) + segment_size + id_size + 48 + 24 + 80 + 24 + reexports_size;
+    const ncmds: u32 = 7 + @as(u32, @intCast(reexports.len));
+
+    // __TEXT holds the headers and a tiny __text section every export
+    // points into; __LINKEDIT holds the export trie and the symbol table.
+    const text_addr = std.mem.alignForward(u64, 32 + sizeofcmds, 16);
+    const text_size = std.mem.alignForward(u64, text_addr + 4, arch.page_size);
+
+    const trie = try exportTrie(arena, symbols, text_addr);
+    var strtab = std.ArrayList(u8).init(arena);
+    try strtab.appendSlice(&.{ ' ', 0 });
+    const strx = try arena.alloc(u32, symbols.len);
+    for (symbols, strx) |symbol, *offset| {
+        offset.* = @intCast(strtab.items.len);
+        try strtab.appendSlice(symbol.name);
+        try strtab.append(0);
+    }
+    const trie_off = text_size;
+    const symoff = std.mem.alignForward(u64, trie_off + trie.len, 8);
+    const stroff = symoff + 16 * symbols.len;
+    const linkedit_size = std.mem.alignForward(u64, stroff + strtab.items.len, 8) - trie_off;
+
+    var bytes = std.ArrayList(u8).init(arena);
+    const w = bytes.writer();
+
+    // mach_header_64
+    try w.writeInt(u32, MH_MAGIC_64, .little);
+    try w.writeInt(u32, arch.cputype, .little);
+    try w.writeInt(u32, arch.cpusubtype, .little);
+    try w.writeInt(u32, MH_DYLIB, .little);
+    try w.writeInt(u32, ncmds, .little);
+    try w.writeInt(u32, sizeofcmds, .little);
+    var flags: u32 = MH_NOUNDEFS | MH_DYLDLINK | MH_TWOLEVEL;
+    if (reexports.len == 0) flags |= MH_NO_REEXPORTED_DYLIBS;
+    try w.writeInt(u32, flags, .little);
+    try w.writeInt(u32, 0, .little);
+
+    // LC_SEGMENT_64 __TEXT with one __text section
+    try writeSegment(w, "__TEXT", 0, text_size, 0, text_size, 5, 1);
+    try writeName(w, "__text");
+    try writeName(w, "__TEXT");
+    try w.writeInt(u64, text_addr, .little);
+    try w.writeInt(u64, 4, .little);
+    try w.writeInt(u32, @intCast(text_addr), .little);
+    try w.writeInt(u32, 2, .little);
+    try w.writeInt(u32, 0, .little);
+    try w.writeInt(u32, 0, .little);
+    try w.writeInt(u32, 0x80000400, .little); // S_ATTR_PURE_INSTRUCTIONS | S_ATTR_SOME_INSTRUCTIONS
+    try w.writeInt(u32, 0, .little);
+    try w.writeInt(u32, 0, .little);
+    try w.writeInt(u32, 0, .little);
+
+    // LC_SEGMENT_64 __LINKEDIT
+    try writeSegment(w, "__LINKEDIT", text_size, std.mem.alignForward(u64, linkedit_size, arch.page_size), trie_off, linkedit_size, 1, 0);
+
+    try writeDylibCommand(w, LC_ID_DYLIB, doc.install_name, tbd.packVersion(doc.current_version), tbd.packVersion(doc.compatibility_version));
+
+    // LC_DYLD_INFO_ONLY: exports only
+    try w.writeInt(u32, LC_DYLD_INFO_ONLY, .little);
+    try w.writeInt(u32, 48, .little);
+    for (0..8) |_| try w.writeInt(u32, 0, .little);
+    try w.writeInt(u32, @intCast(trie_off), .little);
+    try w.writeInt(u32, @intCast(trie.len), .little);
+
+    // LC_SYMTAB
+    try w.writeInt(u32, LC_SYMTAB, .little);
+    try w.writeInt(u32, 24, .little);
+    try w.writeInt(u32, @intCast(symoff), .little);
+    try w.writeInt(u32, @intCast(symbols.len), .little);
+    try w.writeInt(u32, @intCast(stroff), .little);
+    try w.writeInt(u32, @intCast(strtab.items.len), .little);
+
+    // LC_DYSYMTAB: every symbol is an external definition
+    try w.writeInt(u32, LC_DYSYMTAB, .little);
+    try w.writeInt(u32, 80, .little);
+    try w.writeInt(u32, 0, .little); // ilocalsym
+    try w.writeInt(u32, 0, .little); // nlocalsym
+    try w.writeInt(u32, 0, .little); // iextdefsym
+    try w.writeInt(u32, @intCast(symbols.len), .little); // nextdefsym
+    try w.writeInt(u32, @intCast(symbols.len), .little); // iundefsym
+    for (0..13) |_| try w.writeInt(u32, 0, .little);
+
+    // LC_BUILD_VERSION
+    try w.writeInt(u32, LC_BUILD_VERSION, .little);
+    try w.writeInt(u32, 24, .little);
+    try w.writeInt(u32, PLATFORM_MACOS, .little);
+    try w.writeInt(u32, arch.minos, .little);
+    try w.writeInt(u32, arch.minos, .little);
+    try w.writeInt(u32, 0, .little);
+
+    for (reexports) |library| try writeDylibCommand(w, LC_REEXPORT_DYLIB, library, 0x10000, 0x10000);
+    std.debug.assert(bytes.items.len == 32 + sizeofcmds);
+
+    try bytes.appendNTimes(0, text_size - bytes.items.len);
+    try bytes.appendSlice(trie);
+    try bytes.appendNTimes(0, symoff - bytes.items.len);
+    for (symbols, strx) |symbol, offset| {
+        try w.writeInt(u32, offset, .little);
+        try w.writeByte(N_SECT | N_EXT);
+        try w.writeByte(1);
+        try w.writeInt(u16, if (symbol.flags & EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION != 0) N_WEAK_DEF else 0, .little);
+        try w.writeInt(u64, text_addr, .little);
+    }
+    try bytes.appendSlice(strtab.items);
+    try bytes.appendNTimes(0, trie_off + linkedit_size - bytes.items.len);
+    return bytes.items;
+}
+
+fn writeSegment(
+    w: anytype,
+    name: []const u8,
+    vmaddr: u64,
+    vmsize: u64,
+    fileoff: u64,
+    filesize: u64,
+    prot: u32,
+    nsects: u32,
+) !void {
+    try w.writeInt(u32, LC_SEGMENT_64, .little);
+    try w.writeInt(u32, 72 + 80 * nsects, .little);
+    try writeName(w, name);
+    try w.writeInt(u64, vmaddr, .little);
+    try w.writeInt(u64, vmsize, .little);
+    try w.writeInt(u64, fileoff, .little);
+    try w.writeInt(u64, filesize, .little);
+    try w.writeInt(u32, prot, .little);
+    try w.writeInt(u32, prot, .little);
+    try w.writeInt(u32, nsects, .little);
+    try w.writeInt(u32, 0, .little);
+}
+
+fn writeName(w: anytype, name: []const u8) !void {
+    var buf = [_]u8{0} ** 16;
+    @memcpy(buf[0..name.len], name);
+    try w.writeAll(&buf);
+}
+
+fn dylibCommandSize(name: []const u8) u32 {
+    return @intCast(std.mem.alignForward(usize, 24 + name.len + 1, 8));
+}
+
+fn writeDylibCommand(w: anytype, cmd: u32, name: []const u8, current: u32, compatibility: u32) !void {
+    const size = dylibCommandSize(name);
+    try w.writeInt(u32, cmd, .little);
+    try w.writeInt(u32, size, .little);
+    try w.writeInt(u32, 24, .little);
+    try w.writeInt(u32, 2, .little);
+    try w.writeInt(u32, current, .little);
+    try w.writeInt(u32, compatibility, .little);
+    try w.writeAll(name);
+    try w.writeByteNTimes(0, size - 24 - name.len);
+}
+
+const TrieNode = struct {
+    terminal: ?u8 = null,
+    edges: std.ArrayListUnmanaged(Edge) = .empty,
+    offset: u32 = 0,
+
+    const Edge = struct {
+        label: []const u8,
+        node: *TrieNode,
+    };
+
+    fn insert(node: *TrieNode, arena: std.mem.Allocator, key: []const u8, flags: u8) !void {
+        if (key.len == 0) {
+            node.terminal = flags;
+            return;
+        }
+        for (node.edges.items) |*edge| {
+            const common = std.mem.indexOfDiff(u8, edge.label, key) orelse edge.label.len;
+            if (common == 0) continue;
+            if (common < edge.label.len) {
+                const mid = try arena.create(TrieNode);
+                mid.* = .{};
+                try mid.edges.append(arena, .{ .label = edge.label[common..], .node = edge.node });
+                edge.* = .{ .label = edge.label[0..common], .node = mid };
+            }
+            return edge.node.insert(arena, key[common..], flags);
+        }
+        const leaf = try arena.create(TrieNode);
+        leaf.* = .{ .terminal = flags };
+        try node.edges.append(arena, .{ .label = key, .node = leaf });
+    }
+
+    fn terminalSize(node: *const TrieNode, address: u64) u64 {
+        const flags = node.terminal orelse return 0;
+        return ulebSize(flags) + ulebSize(address);
+    }
+
+    fn size(node: *const TrieNode, address: u64) u64 {
+        const terminal = node.terminalSize(address);
+        var total = ulebSize(terminal) + terminal + 1;
+        for (node.edges.items) |edge| total += edge.label.len + 1 + ulebSize(edge.node.offset);
+        return total;
+    }
+};
+
+fn exportTrie(arena: std.mem.Allocator, symbols: []const Symbol, address: u64) ![]u8 {
+    const root = try arena.create(TrieNode);
+    root.* = .{};
+    for (symbols) |symbol| try root.insert(arena, symbol.name, symbol.flags);
+
+    var nodes = std.ArrayList(*TrieNode).init(arena);
+    try nodes.append(root);
+    var i: usize = 0;
+    while (i < nodes.items.len) : (i += 1) {
+        for (nodes.items[i].edges.items) |edge| try nodes.append(edge.node);
+    }
+
+    // Child offsets are ULEB128 encoded, so iterate until the layout settles.
+    while (true) {
+        var offset: u64 = 0;
+        var changed = false;
+        for (nodes.items) |node| {
+            if (node.offset != offset) {
+                node.offset = @intCast(offset);
+                changed = true;
+            }
+            offset += node.size(address);
+        }
+        if (!changed) break;
+    }
+
+    var bytes = std.ArrayList(u8).init(arena);
+    const w = bytes.writer();
+    for (nodes.items) |node| {
+        std.debug.assert(bytes.items.len == node.offset);
+        try std.leb.writeUleb128(w, node.terminalSize(address));
+        if (node.terminal) |flags| {
+            try std.leb.writeUleb128(w, flags);
+            try std.leb.writeUleb128(w, address);
+        }
+        try w.writeByte(@intCast(node.edges.items.len));
+        for (node.edges.items) |edge| {
+            try w.writeAll(edge.label);
+            try w.writeByte(0);
+            try std.leb.writeUleb128(w, edge.node.offset);
+        }
+    }
+    try bytes.appendNTimes(0, std.mem.alignForward(usize, bytes.items.len, 8) - bytes.items.len);
+    return bytes.items;
+}
+
+fn ulebSize(value: u64) u64 {
+    var v = value;
+    var n: u64 = 1;
+    while (v >= 0x80) : (v >>= 7) n += 1;
+    return n;
+}
+
+test "a generated stub exports the symbols of its text stub and re-exports" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    // The umbrella inlines Inner, which it re-exports, and re-exports
+    // libexternal, which it does not describe.
+    const docs = try tbd.parse(arena,
+        \\--- !tapi-tbd
+        \\tbd-version:     4
+        \\targets:         [ x86_64-macos, arm64-macos ]
+        \\install-name:    '/System/Library/Frameworks/Umbrella.framework/Versions/A/Umbrella'
+        \\current-version: 1.2.3
+        \\compatibility-version: 1
+        \\reexported-libraries:
+        \\  - targets:         [ x86_64-macos, arm64-macos ]
+        \\    libraries:       [ '/System/Library/Frameworks/Umbrella.framework/Versions/A/Frameworks/Inner.framework/Versions/A/Inner',
+        \\                       '/usr/lib/libexternal.dylib' ]
+        \\exports:
+        \\  - targets:         [ x86_64-macos, arm64-macos ]
+        \\    symbols:         [ _umbrella_a, _umbrella_b ]
+        \\    objc-classes:    [ UMBView ]
+        \\  - targets:         [ arm64-macos ]
+        \\    weak-symbols:    [ _arm64_weak ]
+        \\  - targets:         [ x86_64-macos ]
+        \\    symbols:         [ _x86_64_only ]
+        \\--- !tapi-tbd
+        \\tbd-version:     4
+        \\targets:         [ x86_64-macos, arm64-macos ]
+        \\install-name:    '/System/Library/Frameworks/Umbrella.framework/Versions/A/Frameworks/Inner.framework/Versions/A/Inner'
+        \\exports:
+        \\  - targets:         [ x86_64-macos, arm64-macos ]
+        \\    symbols:         [ _inner, _umbrella_a ]
+        \\    thread-local-symbols: [ _inner_tls ]
+        \\--- !tapi-tbd
+        \\tbd-version:     4
+        \\targets:         [ x86_64-macos, arm64-macos ]
+        \\install-name:    '/usr/lib/libunrelated.dylib'
+        \\exports:
+        \\  - targets:         [ x86_64-macos, arm64-macos ]
+        \\    symbols:         [ _unrelated ]
+        \\...
+        \\
+    );
+    const bytes = try writeDylib(arena, aarch64, docs);
+
+    try std.testing.expectEqual(MH_MAGIC_64, std.mem.readInt(u32, bytes[0..4], .little));
+    try std.testing.expectEqual(aarch64.cputype, std.mem.readInt(u32, bytes[4..8], .little));
+    try std.testing.expectEqual(MH_DYLIB, std.mem.readInt(u32, bytes[12..16], .little));
+    try std.testing.expectEqual(0, std.mem.readInt(u32, bytes[24..28], .little) & MH_NO_REEXPORTED_DYLIBS);
+
+    var id: ?[]const u8 = null;
+    var reexports = std.ArrayList([]const u8).init(arena);
+    var trie: []const u8 = &.{};
+    var symtab: []const u8 = &.{};
+    var strtab: []const u8 = &.{};
+    var offset: usize = 32;
+    for (0..std.mem.readInt(u32, bytes[16..20], .little)) |_| {
+        const cmd = bytes[offset..];
+        const field = struct {
+            fn at(command: []const u8, index: usize) u32 {
+                return std.mem.readInt(u32, command[4 * index ..][0..4], .little);
+            }
+        }.at;
+        switch (field(cmd, 0)) {
+            LC_ID_DYLIB => {
+                id = std.mem.sliceTo(cmd[field(cmd, 2)..], 0);
+                try std.testing.expectEqual(0x00010203, field(cmd, 4));
+                try std.testing.expectEqual(0x00010000, field(cmd, 5));
+            },
+            LC_REEXPORT_DYLIB => try reexports.append(std.mem.sliceTo(cmd[field(cmd, 2)..], 0)),
+            LC_DYLD_INFO_ONLY => trie = bytes[field(cmd, 10)..][0..field(cmd, 11)],
+            LC_SYMTAB => {
+                symtab = bytes[field(cmd, 2)..][0 .. 16 * field(cmd, 3)];
+                strtab = bytes[field(cmd, 4)..][0..field(cmd, 5)];
+            },
+            else => {},
+        }
+        offset += field(cmd, 1);
+    }
+
+    try std.testing.expectEqualStrings("/System/Library/Frameworks/Umbrella.framework/Versions/A/Umbrella", id.?);
+    try std.testing.expectEqual(1, reexports.items.len);
+    try std.testing.expectEqualStrings("/usr/lib/libexternal.dylib", reexports.items[0]);
+
+    const expected = [_]struct { []const u8, u64 }{
+        .{ "_OBJC_CLASS_$_UMBView", 0 },
+        .{ "_OBJC_METACLASS_$_UMBView", 0 },
+        .{ "_arm64_weak", EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION },
+        .{ "_inner", 0 },
+        .{ "_inner_tls", EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL },
+        .{ "_umbrella_a", 0 },
+        .{ "_umbrella_b", 0 },
+    };
+    var exports = std.StringArrayHashMap(u64).init(arena);
+    try readTrie(arena, trie, 0, "", &exports);
+    try std.testing.expectEqual(expected.len, exports.count());
+    for (expected) |symbol| try std.testing.expectEqual(symbol[1], exports.get(symbol[0]).?);
+
+    try std.testing.expectEqual(expected.len, symtab.len / 16);
+    for (expected, 0..) |symbol, i| {
+        const nlist = symtab[16 * i ..][0..16];
+        try std.testing.expectEqualStrings(symbol[0], std.mem.sliceTo(strtab[std.mem.readInt(u32, nlist[0..4], .little)..], 0));
+        try std.testing.expectEqual(N_SECT | N_EXT, nlist[4]);
+    }
+}
+
+/// Collects the symbols of an export trie with their flags.
+fn readTrie(arena: std.mem.Allocator, trie: []const u8, offset: usize, prefix: []const u8, exports: *std.StringArrayHashMap(u64)) !void {
+    var stream = std.io.fixedBufferStream(trie[offset..]);
+    const r = stream.reader();
+    if (try std.leb.readUleb128(u64, r) != 0) {
+        const flags = try std.leb.readUleb128(u64, r);
+        _ = try std.leb.readUleb128(u64, r);
+        try exports.putNoClobber(prefix, flags);
+    }
+    for (0..try r.readByte()) |_| {
+        const label = try r.readUntilDelimiterAlloc(arena, 0, 4096);
+        const child = try std.leb.readUleb128(u64, r);
+        try readTrie(arena, trie, @intCast(child), try std.mem.concat(arena, u8, &.{ prefix, label }), exports);
+    }
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
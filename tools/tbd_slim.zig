@@ -0,0 +1,159 @@
+//! Restricts TAPI v4 text stubs in place to a set of targets: target lists
+//! are filtered, sections for other targets are dropped, and so are
+//! sequences and documents left without any target.
+//!
+//! Usage: tbd_slim --keep arm64-macos,arm64e-macos <file.tbd>...
+
+const std = @import("std");
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 3 or !std.mem.eql(u8, args[1], "--keep"))
+        fatal("usage: {s} --keep <target>[,<target>...] <file.tbd>...", .{args[0]});
+
+    var keep = std.ArrayList([]const u8).init(arena);
+    var it = std.mem.tokenizeScalar(u8, args[2], ',');
+    while (it.next()) |target| try keep.append(target);
+
+    for (args[3..]) |path| {
+        const src = try std.fs.cwd().readFileAlloc(arena, path, 1 << 30);
+        const out = try slim(arena, src, keep.items);
+        try std.fs.cwd().writeFile(.{ .sub_path = path, .data = out });
+    }
+}
+
+fn slim(arena: std.mem.Allocator, src: []const u8, keep: []const []const u8) ![]u8 {
+    var lines = std.ArrayList([]const u8).init(arena);
+    var split = std.mem.splitScalar(u8, src, '\n');
+    while (split.next()) |line| try lines.append(line);
+    if (lines.items.len > 0 and lines.items[lines.items.len - 1].len == 0) _ = lines.pop();
+
+    var out = std.ArrayList(u8).init(arena);
+    var doc = std.ArrayList(u8).init(arena);
+    var doc_has_targets = true;
+    var i: usize = 0;
+    while (i < lines.items.len) {
+        const line = lines.items[i];
+        if (std.mem.startsWith(u8, line, "---")) {
+            try flushDocument(&out, &doc, doc_has_targets);
+            doc_has_targets = true;
+        }
+        if (line.len == 0 or line[0] == ' ' or std.mem.startsWith(u8, line, "---") or std.mem.eql(u8, line, "...")) {
+            try doc.appendSlice(line);
+            try doc.append('\n');
+            i += 1;
+            continue;
+        }
+
+        // A top-level key and its indented continuation lines.
+        var end = i + 1;
+        while (end < lines.items.len and lines.items[end].len > 0 and lines.items[end][0] == ' ') end += 1;
+        const block = lines.items[i..end];
+        i = end;
+
+        if (std.mem.startsWith(u8, line, "targets:")) {
+            const rewritten = try rewriteTargets(arena, block, keep) orelse {
+                doc_has_targets = false;
+                continue;
+            };
+            try doc.appendSlice(rewritten);
+            continue;
+        }
+        if (block.len > 1 and std.mem.startsWith(u8, block[1], "  - ")) {
+            var items = std.ArrayList(u8).init(arena);
+            var start: usize = 1;
+            while (start < block.len) {
+                var item_end = start + 1;
+                while (item_end < block.len and !std.mem.startsWith(u8, block[item_end], "  - ")) item_end += 1;
+                if (try filterItem(arena, block[start..item_end], keep)) |item| try items.appendSlice(item);
+                start = item_end;
+            }
+            if (items.items.len > 0) {
+                try doc.appendSlice(block[0]);
+                try doc.append('\n');
+                try doc.appendSlice(items.items);
+            }
+            continue;
+        }
+        for (block) |block_line| {
+            try doc.appendSlice(block_line);
+            try doc.append('\n');
+        }
+    }
+    try flushDocument(&out, &doc, doc_has_targets);
+    return out.items;
+}
+
+fn flushDocument(out: *std.ArrayList(u8), doc: *std.ArrayList(u8), has_targets: bool) !void {
+    if (has_targets) try out.appendSlice(doc.items);
+    doc.clearRetainingCapacity();
+}
+
+/// Filters one sequence item (`- targets: [...]` or `- target: ...`) and
+/// returns its lines, or null if none of its targets are kept.
+fn filterItem(arena: std.mem.Allocator, item: []const []const u8, keep: []const []const u8) !?[]const u8 {
+    const first = std.mem.trimLeft(u8, item[0], " -");
+    if (std.mem.startsWith(u8, first, "target:")) {
+        const target = std.mem.trim(u8, first["target:".len..], " ");
+        if (!contains(keep, target)) return null;
+        return try joinLines(arena, item);
+    }
+
+    for (item, 0..) |line, start| {
+        const key = std.mem.trimLeft(u8, line, " -");
+        if (!std.mem.startsWith(u8, key, "targets:")) continue;
+        var end = start;
+        while (std.mem.indexOfScalar(u8, item[end], ']') == null and end + 1 < item.len) end += 1;
+        const rewritten = try rewriteTargets(arena, item[start .. end + 1], keep) orelse return null;
+        return try std.mem.concat(arena, u8, &.{
+            try joinLines(arena, item[0..start]),
+            rewritten,
+            try joinLines(arena, item[end + 1 ..]),
+        });
+    }
+    return try joinLines(arena, item);
+}
+
+/// Rewrites a possibly multi-line `targets: [ ... ]` flow list on a single
+/// line, keeping only the requested targets. Returns null if none are left.
+fn rewriteTargets(arena: std.mem.Allocator, lines: []const []const u8, keep: []const []const u8) !?[]const u8 {
+    const open = std.mem.indexOfScalar(u8, lines[0], '[') orelse return try joinLines(arena, lines);
+    const text = try std.mem.join(arena, " ", lines);
+    const close = std.mem.lastIndexOfScalar(u8, text, ']') orelse return try joinLines(arena, lines);
+
+    var kept = std.ArrayList([]const u8).init(arena);
+    var targets = std.mem.tokenizeAny(u8, text[open + 1 .. close], ", ");
+    while (targets.next()) |target| {
+        if (contains(keep, target)) try kept.append(target);
+    }
+    if (kept.items.len == 0) return null;
+    return try std.fmt.allocPrint(arena, "{s}[ {s} ]\n", .{
+        lines[0][0..open],
+        try std.mem.join(arena, ", ", kept.items),
+    });
+}
+
+fn joinLines(arena: std.mem.Allocator, lines: []const []const u8) ![]const u8 {
+    var out = std.ArrayList(u8).init(arena);
+    for (lines) |line| {
+        try out.appendSlice(line);
+        try out.append('\n');
+    }
+    return out.items;
+}
+
+fn contains(haystack: []const []const u8, needle: []const u8) bool {
+    for (haystack) |item| {
+        if (std.mem.eql(u8, item, needle)) return true;
+    }
+    return false;
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
@@ -0,0 +1,233 @@
+//! Merges the `-ftime-trace` JSON files clang writes for every translation
+//! unit of a compile step and ranks SDK headers by the frontend time spent
+//! parsing them, grouped by framework and by header family.
+//!
+//! Usage: time_trace <sdk-frameworks-dir> <sdk-include-dir> <top> <trace>...
+
+const std = @import("std");
+
+const Source = struct {
+    ts: i64,
+    dur: i64,
+    path: []const u8,
+};
+
+const Entry = struct {
+    self_us: i64 = 0,
+    tus: u32 = 0,
+    last_tu: u32 = std.math.maxInt(u32),
+
+    fn add(entry: *Entry, tu: u32, us: i64) void {
+        entry.self_us += us;
+        if (entry.last_tu != tu) {
+            entry.last_tu = tu;
+            entry.tus += 1;
+        }
+    }
+};
+
+pub fn main() !void {
+    var arena_state = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    if (args.len < 4) fatal("usage: {s} <sdk-frameworks-dir> <sdk-include-dir> <top> <trace>...", .{args[0]});
+    const frameworks_dir = try std.fs.cwd().realpathAlloc(arena, args[1]);
+    const include_dir = try std.fs.cwd().realpathAlloc(arena, args[2]);
+    const top = try std.fmt.parseInt(usize, args[3], 10);
+
+    var groups = std.StringArrayHashMap(Entry).init(arena);
+    var families = std.StringArrayHashMap(Entry).init(arena);
+    var real_paths = std.StringHashMap([]const u8).init(arena);
+    var total_us: i64 = 0;
+    var sdk_us: i64 = 0;
+    var tu_count: u32 = 0;
+
+    for (args[4..]) |trace| {
+        // A compile replayed from the compiler's own cache writes no trace.
+        const bytes = std.fs.cwd().readFileAlloc(arena, trace, 1 << 30) catch |err| {
+            std.log.warn("skipping '{s}': {s}", .{ trace, @errorName(err) });
+            continue;
+        };
+        const root = std.json.parseFromSliceLeaky(std.json.Value, arena, bytes, .{}) catch |err| {
+            std.log.warn("skipping '{s}': {s}", .{ trace, @errorName(err) });
+            continue;
+        };
+        if (root != .object) continue;
+        const events = root.object.get("traceEvents") orelse continue;
+        if (events != .array) continue;
+
+        var sources = std.ArrayList(Source).init(arena);
+        for (events.array.items) |event| {
+            if (event != .object) continue;
+            const obj = event.object;
+            const ph = stringField(obj, "ph") orelse continue;
+            if (!std.mem.eql(u8, ph, "X")) continue;
+            const name = stringField(obj, "name") orelse continue;
+            const dur = intField(obj, "dur") orelse continue;
+            if (std.mem.eql(u8, name, "Frontend")) {
+                total_us += dur;
+                continue;
+            }
+            if (!std.mem.eql(u8, name, "Source")) continue;
+            const ev_args = obj.get("args") orelse continue;
+            if (ev_args != .object) continue;
+            try sources.append(.{
+                .ts = intField(obj, "ts") orelse continue,
+                .dur = dur,
+                .path = stringField(ev_args.object, "detail") orelse continue,
+            });
+        }
+
+        // Source events nest the way headers include each other, so the
+        // self time of a header is its duration minus that of its children.
+        std.mem.sort(Source, sources.items, {}, sourceLessThan);
+        const self_us = try arena.alloc(i64, sources.items.len);
+        var stack = std.ArrayList(usize).init(arena);
+        for (sources.items, 0..) |source, i| {
+            self_us[i] = source.dur;
+            while (stack.items.len > 0) {
+                const parent = sources.items[stack.items[stack.items.len - 1]];
+                if (source.ts < parent.ts + parent.dur) break;
+                _ = stack.pop();
+            }
+            if (stack.items.len > 0) self_us[stack.items[stack.items.len - 1]] -= source.dur;
+            try stack.append(i);
+        }
+
+        for (sources.items, self_us) |source, us| {
+            const real = real_paths.get(source.path) orelse blk: {
+                const resolved = std.fs.cwd().realpathAlloc(arena, source.path) catch source.path;
+                try real_paths.put(source.path, resolved);
+                break :blk resolved;
+            };
+            const group_name, const family_name = classify(arena, frameworks_dir, include_dir, real) orelse continue;
+            sdk_us += us;
+            const group_entry = try groups.getOrPut(group_name);
+            if (!group_entry.found_existing) group_entry.value_ptr.* = .{};
+            group_entry.value_ptr.add(tu_count, us);
+            const family_entry = try families.getOrPut(family_name);
+            if (!family_entry.found_existing) family_entry.value_ptr.* = .{};
+            family_entry.value_ptr.add(tu_count, us);
+        }
+        tu_count += 1;
+    }
+
+    const stdout = std.io.getStdOut().writer();
+    try stdout.print("SDK headers: {d:.1} ms of {d:.1} ms frontend time ({d:.1}%) across {d} TUs\n", .{
+        ms(sdk_us), ms(total_us), percent(sdk_us, total_us), tu_count,
+    });
+    try printRanking(stdout, "By framework", &groups, total_us, top);
+    try printRanking(stdout, "By header", &families, total_us, top);
+}
+
+fn printRanking(
+    writer: anytype,
+    title: []const u8,
+    map: *std.StringArrayHashMap(Entry),
+    total_us: i64,
+    top: usize,
+) !void {
+    const SortContext = struct {
+        values: []const Entry,
+        pub fn lessThan(ctx: @This(), a: usize, b: usize) bool {
+            return ctx.values[a].self_us > ctx.values[b].self_us;
+        }
+    };
+    map.sort(SortContext{ .values = map.values() });
+
+    try writer.print("\n{s}:\n", .{title});
+    for (map.keys()[0..@min(top, map.count())], map.values()[0..@min(top, map.count())]) |name, entry| {
+        try writer.print("  {d:>5.1}%  {d:>10.1} ms  {d:>5} TUs  {s}\n", .{
+            percent(entry.self_us, total_us), ms(entry.self_us), entry.tus, name,
+        });
+    }
+}
+
+/// Returns the framework group ("ApplicationServices/HIServices") and the
+/// header family ("AppKit/NSAccessibility*.h") of an SDK header, or null if
+/// `path` is not part of the SDK.
+fn classify(
+    arena: std.mem.Allocator,
+    frameworks_dir: []const u8,
+    include_dir: []const u8,
+    path: []const u8,
+) ?struct { []const u8, []const u8 } {
+    const basename = std.fs.path.basename(path);
+    if (relativeTo(frameworks_dir, path)) |rel| {
+        var group = std.ArrayList(u8).init(arena);
+        var components = std.mem.tokenizeScalar(u8, rel, '/');
+        while (components.next()) |component| {
+            if (!std.mem.endsWith(u8, component, ".framework")) continue;
+            if (group.items.len > 0) group.append('/') catch return null;
+            group.appendSlice(component[0 .. component.len - ".framework".len]) catch return null;
+        }
+        const ext = std.fs.path.extension(basename);
+        const stem = basename[0 .. basename.len - ext.len];
+        const fam = family(stem);
+        const family_name = std.fmt.allocPrint(arena, "{s}/{s}{s}{s}", .{
+            group.items, fam, if (fam.len < stem.len) "*" else "", ext,
+        }) catch return null;
+        return .{ group.items, family_name };
+    }
+    if (relativeTo(include_dir, path)) |rel| {
+        const first = std.mem.indexOfScalar(u8, rel, '/');
+        const group = if (first) |i|
+            std.fmt.allocPrint(arena, "include/{s}", .{rel[0..i]}) catch return null
+        else
+            "include";
+        const family_name = std.fmt.allocPrint(arena, "include/{s}", .{rel}) catch return null;
+        return .{ group, family_name };
+    }
+    return null;
+}
+
+fn relativeTo(dir: []const u8, path: []const u8) ?[]const u8 {
+    if (!std.mem.startsWith(u8, path, dir)) return null;
+    if (path.len <= dir.len or path[dir.len] != '/') return null;
+    return path[dir.len + 1 ..];
+}
+
+/// The family of a header is its capitalized prefix plus the first word
+/// after it, so "NSAccessibilityConstants" belongs to "NSAccessibility".
+fn family(stem: []const u8) []const u8 {
+    var i: usize = 0;
+    while (i < stem.len and std.ascii.isUpper(stem[i])) i += 1;
+    if (i < 2 or i == stem.len) return stem;
+    while (i < stem.len and !std.ascii.isUpper(stem[i])) i += 1;
+    return stem[0..i];
+}
+
+fn sourceLessThan(_: void, a: Source, b: Source) bool {
+    if (a.ts != b.ts) return a.ts < b.ts;
+    return a.dur > b.dur;
+}
+
+fn stringField(obj: std.json.ObjectMap, name: []const u8) ?[]const u8 {
+    const value = obj.get(name) orelse return null;
+    return if (value == .string) value.string else null;
+}
+
+fn intField(obj: std.json.ObjectMap, name: []const u8) ?i64 {
+    const value = obj.get(name) orelse return null;
+    return switch (value) {
+        .integer => |int| int,
+        .float => |float| @intFromFloat(float),
+        else => null,
+    };
+}
+
+fn ms(us: i64) f64 {
+    return @as(f64, @floatFromInt(us)) / 1000.0;
+}
+
+fn percent(part: i64, whole: i64) f64 {
+    if (whole == 0) return 0;
+    return 100.0 * @as(f64, @floatFromInt(part)) / @as(f64, @floatFromInt(whole));
+}
+
+fn fatal(comptime format: []const u8, args: anytype) noreturn {
+    std.log.err(format, args);
+    std.process.exit(1);
+}
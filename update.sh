@@ -2,11 +2,31 @@
 set -euo pipefail
 set -x
 
+# Pass `--arm64-variant [dir]` to also produce an Apple silicon-only copy of
+# the package, by default next to this repository.
+arm64_variant=""
+if [ "${1:-}" = "--arm64-variant" ]; then
+  arm64_variant="${2:-../zig-build-macos-sdk-arm64}"
+fi
+
 sdk=$(xcrun --sdk macosx --show-sdk-path)
 frameworks="$sdk/System/Library/Frameworks"
 includes="$sdk/usr/include"
 libs="$sdk/usr/lib"
 
+# Fails the update when the stubs of a framework, including its
+# sub-frameworks, stop exporting a symbol the framework is shipped for.
+check_exports() {
+  local framework=$1
+  shift
+  for symbol in "$@"; do
+    if ! grep -rqw --include='*.tbd' -- "$symbol" "Frameworks/$framework.framework"; then
+      echo "Frameworks/$framework.framework does not export $symbol" >&2
+      exit 1
+    fi
+  done
+}
+
 rm -rf Frameworks/
 rm -rf include/
 rm -rf lib/
@@ -23,6 +43,19 @@ rm -rf ./include/apache2
 mkdir -p lib/
 cp $libs/libobjc.tbd ./lib/
 cp $libs/libobjc.A.tbd ./lib/
+cp $libs/libc++.tbd ./lib/
+cp $libs/libc++.1.tbd ./lib/
+cp $libs/libc++abi.tbd ./lib/
+
+# System libraries whose headers are shipped in include/
+cp $libs/libz.tbd ./lib/
+cp $libs/libbz2.tbd ./lib/
+cp $libs/libsqlite3.tbd ./lib/
+cp $libs/libcompression.tbd ./lib/
+cp $libs/libiconv.tbd ./lib/
+cp $libs/libxml2.tbd ./lib/
+cp $libs/libcurl.tbd ./lib/
+cp $libs/libffi.tbd ./lib/
 
 # General frameworks
 cp -R $frameworks/CoreFoundation.framework ./Frameworks/CoreFoundation.framework
@@ -32,6 +65,7 @@ cp -R $frameworks/Security.framework ./Frameworks/Security.framework
 cp -R $frameworks/CoreServices.framework ./Frameworks/CoreServices.framework
 cp -R $frameworks/DiskArbitration.framework ./Frameworks/DiskArbitration.framework
 cp -R $frameworks/CFNetwork.framework ./Frameworks/CFNetwork.framework
+cp -R $frameworks/Network.framework ./Frameworks/Network.framework
 cp -R $frameworks/ApplicationServices.framework ./Frameworks/ApplicationServices.framework
 cp -R $frameworks/ImageIO.framework ./Frameworks/ImageIO.framework
 cp -R $frameworks/GameController.framework ./Frameworks/GameController.framework
@@ -45,6 +79,8 @@ cp -R $frameworks/AudioUnit.framework ./Frameworks/AudioUnit.framework
 
 # Graphics frameworks
 cp -R $frameworks/Metal.framework ./Frameworks/Metal.framework
+cp -R $frameworks/MetalKit.framework ./Frameworks/MetalKit.framework
+cp -R $frameworks/MetalPerformanceShaders.framework ./Frameworks/MetalPerformanceShaders.framework
 cp -R $frameworks/OpenGL.framework ./Frameworks/OpenGL.framework
 cp -R $frameworks/CoreGraphics.framework ./Frameworks/CoreGraphics.framework
 cp -R $frameworks/IOSurface.framework ./Frameworks/IOSurface.framework
@@ -54,6 +90,19 @@ cp -R $frameworks/CoreVideo.framework ./Frameworks/CoreVideo.framework
 cp -R $frameworks/CoreText.framework ./Frameworks/CoreText.framework
 cp -R $frameworks/ColorSync.framework ./Frameworks/ColorSync.framework
 
+# Video frameworks: hardware codecs and the sample buffers they consume,
+# on top of the CoreVideo pixel buffers above
+cp -R $frameworks/CoreMedia.framework ./Frameworks/CoreMedia.framework
+cp -R $frameworks/VideoToolbox.framework ./Frameworks/VideoToolbox.framework
+
+# Screen capture: SCStream delivers frames as IOSurface-backed CVPixelBuffers,
+# without the CPU copies of CGDisplayStream/CGWindowListCreateImage
+cp -R $frameworks/ScreenCaptureKit.framework ./Frameworks/ScreenCaptureKit.framework
+
+# Numerics: vDSP, vImage, BLAS/LAPACK and BNNS, with vecLib and vImage as
+# sub-frameworks
+cp -R $frameworks/Accelerate.framework ./Frameworks/Accelerate.framework
+
 # GLFW dependencies
 cp -R $frameworks/Carbon.framework ./Frameworks/Carbon.framework
 cp -R $frameworks/Cocoa.framework ./Frameworks/Cocoa.framework
@@ -99,3 +148,55 @@ rm ./Frameworks/CloudKit.framework/Versions/A/CloudKit.tbd
 
 # Remove all broken symlinks
 find . -type l ! -exec test -e {} \; -exec rm {} ';'
+
+# The APIs the frameworks below are shipped for
+check_exports Accelerate _vDSP_fft_zrip _vImageScale_ARGB8888 _cblas_sgemm _BNNSFilterApply
+check_exports ScreenCaptureKit SCStream SCStreamConfiguration SCContentFilter SCShareableContent
+check_exports MetalKit MTKTextureLoader MTKView
+check_exports MetalPerformanceShaders MPSImageGaussianBlur MPSMatrixMultiplication
+check_exports Network _nw_connection_create _nw_connection_send _nw_connection_receive_message _nw_connection_batch
+check_exports CoreMedia _CMSampleBufferGetImageBuffer _CMVideoFormatDescriptionCreateForImageBuffer
+check_exports VideoToolbox _VTCompressionSessionCreate _VTCompressionSessionEncodeFrame _VTDecompressionSessionDecodeFrame
+
+# Apple silicon-only variant: only the arm64/arm64e slices of every stub and
+# no x86 headers or GPU plugins.
+if [ -n "$arm64_variant" ]; then
+  rm -rf "$arm64_variant"
+  mkdir -p "$arm64_variant"
+  cp -R Frameworks include lib tools "$arm64_variant/"
+  cp build.zig build.zig.zon LICENSE README.md sdk-stats.json stub.c update.sh verify.sh "$arm64_variant/"
+
+  # A package of its own: another name, with a fingerprint whose upper half
+  # is the CRC-32 of that name, and aarch64 as the only target.
+  sed -i '' \
+    -e 's/^    \.name = \.macos_sdk,$/    .name = .macos_sdk_arm64,/' \
+    -e 's/^    \.fingerprint = 0x[0-9a-f]*,/    .fingerprint = 0xda340ebc5e1f3a27,/' \
+    "$arm64_variant/build.zig.zon"
+  sed -i '' \
+    -e 's/^pub const macos_arches = .*/pub const macos_arches = [_]std.Target.Cpu.Arch{.aarch64};/' \
+    "$arm64_variant/build.zig"
+  grep -q '^    \.name = \.macos_sdk_arm64,$' "$arm64_variant/build.zig.zon"
+  grep -q '^    \.fingerprint = 0xda340ebc5e1f3a27,' "$arm64_variant/build.zig.zon"
+  grep -q '^pub const macos_arches = \[_\]std.Target.Cpu.Arch{\.aarch64};$' "$arm64_variant/build.zig"
+
+  rm -rf "$arm64_variant/include/i386"
+  rm -rf "$arm64_variant/include/architecture/i386"
+  rm -rf "$arm64_variant/include/libkern/i386"
+  rm -rf "$arm64_variant/include/mach/i386"
+  rm -rf "$arm64_variant/include/mach-o/i386"
+  rm -rf "$arm64_variant/Frameworks/Kernel.framework/Versions/A/Headers/i386"
+  rm -rf "$arm64_variant/Frameworks/Kernel.framework/Versions/A/Headers/architecture/i386"
+  rm -rf "$arm64_variant/Frameworks/Kernel.framework/Versions/A/Headers/libkern/i386"
+  rm -rf "$arm64_variant/Frameworks/Kernel.framework/Versions/A/Headers/mach/i386"
+  rm -rf "$arm64_variant/Frameworks/Kernel.framework/Versions/A/Headers/pexpert/i386"
+  rm -rf "$arm64_variant/Frameworks/OpenGL.framework/Versions/A/Libraries/3425AMD"
+
+  find "$arm64_variant" -name '*.tbd' -type f -print0 |
+    xargs -0 zig run tools/tbd_slim.zig -- --keep arm64-macos,arm64e-macos
+  (cd "$arm64_variant" && find . -type l ! -exec test -e {} \; -exec rm {} ';')
+
+  # Size and hash time of both packages.
+  du -sh Frameworks include lib "$arm64_variant/Frameworks" "$arm64_variant/include" "$arm64_variant/lib"
+  zig run tools/sdk_stats.zig -- . | tail -n 1
+  zig run tools/sdk_stats.zig -- "$arm64_variant" --baseline "$arm64_variant/sdk-stats.json" --update | tail -n 3
+fi
@@ -3,3 +3,4 @@ set -euo pipefail
 
 ./update.sh
 git diff
+zig build sdk-stats